@@ -15,8 +15,16 @@
 // specific language governing permissions and limitations
 // under the License.
 
+#include <algorithm>
+#include <deque>
+#include <future>
+#include <thread>
+#include <utility>
+#include <vector>
+
 #include <arrow/api.h>
 #include <arrow/io/api.h>
+#include <arrow/util/thread-pool.h>
 #include <parquet/arrow/reader.h>
 #include <parquet/arrow/writer.h>
 #include <parquet/exception.h>
@@ -67,6 +75,9 @@ void read_whole_file() {
   std::unique_ptr<parquet::arrow::FileReader> reader;
   PARQUET_THROW_NOT_OK(
       parquet::arrow::OpenFile(infile, arrow::default_memory_pool(), &reader));
+  // Decode the columns in parallel on Arrow's CPU thread pool. Its size can
+  // be changed with arrow::SetCpuThreadPoolCapacity().
+  reader->set_use_threads(true);
   std::shared_ptr<arrow::Table> table;
   PARQUET_THROW_NOT_OK(reader->ReadTable(&table));
   std::cout << "Loaded " << table->num_rows() << " rows in " << table->num_columns()
@@ -124,6 +135,180 @@ void read_single_column_chunk() {
   std::cout << std::endl;
 }
 
+// #6: Read the whole file with one task per ColumnChunk. The chunks of each
+//     column become the chunks of a ChunkedArray, so nothing is concatenated.
+void read_whole_file_by_column_chunks(int num_threads) {
+  std::cout << "Reading parquet-arrow-example.parquet by ColumnChunks on "
+            << num_threads << " threads" << std::endl;
+  std::shared_ptr<arrow::io::ReadableFile> infile;
+  PARQUET_THROW_NOT_OK(arrow::io::ReadableFile::Open(
+      "parquet-arrow-example.parquet", arrow::default_memory_pool(), &infile));
+
+  std::unique_ptr<parquet::arrow::FileReader> reader;
+  PARQUET_THROW_NOT_OK(
+      parquet::arrow::OpenFile(infile, arrow::default_memory_pool(), &reader));
+  // The example schema is flat, so every field is a single leaf column
+  std::shared_ptr<arrow::Schema> schema;
+  PARQUET_THROW_NOT_OK(reader->GetSchema(&schema));
+  const int num_row_groups = reader->num_row_groups();
+  const int num_columns = schema->num_fields();
+
+  // The tasks run on Arrow's CPU thread pool, the one FileReader uses when
+  // set_use_threads(true) is set, so both share its capacity setting
+  PARQUET_THROW_NOT_OK(arrow::SetCpuThreadPoolCapacity(num_threads));
+  arrow::internal::ThreadPool* pool = arrow::internal::GetCpuThreadPool();
+
+  // chunks[c][r] holds column c of RowGroup r
+  std::vector<arrow::ArrayVector> chunks(num_columns,
+                                         arrow::ArrayVector(num_row_groups));
+  std::vector<std::future<arrow::Status>> futures;
+  for (int r = 0; r < num_row_groups; ++r) {
+    for (int c = 0; c < num_columns; ++c) {
+      futures.push_back(pool->Submit([&reader, &chunks, r, c]() {
+        return reader->RowGroup(r)->Column(c)->Read(&chunks[c][r]);
+      }));
+    }
+  }
+  // Wait for every task before checking, as they reference this frame
+  for (auto& future : futures) {
+    future.wait();
+  }
+  for (auto& future : futures) {
+    PARQUET_THROW_NOT_OK(future.get());
+  }
+
+  std::vector<std::shared_ptr<arrow::Column>> columns;
+  for (int c = 0; c < num_columns; ++c) {
+    // The type is passed explicitly as a file without RowGroups has no chunks
+    columns.push_back(std::make_shared<arrow::Column>(
+        schema->field(c),
+        std::make_shared<arrow::ChunkedArray>(chunks[c], schema->field(c)->type())));
+  }
+  std::shared_ptr<arrow::Table> table = arrow::Table::Make(schema, columns);
+  std::cout << "Loaded " << table->num_rows() << " rows in " << table->num_columns()
+            << " columns." << std::endl;
+}
+
+// #7: Stream the file as RecordBatches of `batch_size` rows, read column by
+//     column with ColumnReader::NextBatch. Batches span RowGroups, so only
+//     the last one of the file can be shorter. Up to `prefetch` batches are
+//     read ahead on background threads, which bounds memory use to that many
+//     batches plus the one being consumed.
+class StreamingBatchReader : public arrow::RecordBatchReader {
+ public:
+  StreamingBatchReader(std::unique_ptr<parquet::arrow::FileReader> reader,
+                       int64_t batch_size, int prefetch)
+      : reader_(std::move(reader)),
+        batch_size_(batch_size),
+        prefetch_(std::max(prefetch, 1)),
+        finished_(false) {
+    PARQUET_THROW_NOT_OK(reader_->GetSchema(&schema_));
+    // The example schema is flat, so field i is leaf column i
+    for (int i = 0; i < schema_->num_fields(); ++i) {
+      std::unique_ptr<parquet::arrow::ColumnReader> column;
+      PARQUET_THROW_NOT_OK(reader_->GetColumn(i, &column));
+      columns_.push_back(std::move(column));
+    }
+    Prefetch();
+  }
+
+  std::shared_ptr<arrow::Schema> schema() const override { return schema_; }
+
+  arrow::Status ReadNext(std::shared_ptr<arrow::RecordBatch>* out) override {
+    if (pending_.empty()) {
+      *out = nullptr;
+      return arrow::Status::OK();
+    }
+    BatchResult next = pending_.front().get();
+    pending_.pop_front();
+    RETURN_NOT_OK(next.first);
+    if (!next.second) {
+      // End of stream; the batches still pending are empty as well
+      finished_ = true;
+    }
+    Prefetch();
+    *out = next.second;
+    return arrow::Status::OK();
+  }
+
+ private:
+  using BatchResult = std::pair<arrow::Status, std::shared_ptr<arrow::RecordBatch>>;
+
+  // Reads the next `batch_size_` rows of every column, or returns a null
+  // batch at the end of the file
+  BatchResult ReadBatch() {
+    arrow::ArrayVector arrays(columns_.size());
+    for (size_t i = 0; i < columns_.size(); ++i) {
+      arrow::Status status = columns_[i]->NextBatch(batch_size_, &arrays[i]);
+      if (!status.ok()) {
+        return BatchResult(status, nullptr);
+      }
+    }
+    if (arrays.empty() || !arrays[0] || arrays[0]->length() == 0) {
+      return BatchResult(arrow::Status::OK(), nullptr);
+    }
+    return BatchResult(arrow::Status::OK(),
+                       arrow::RecordBatch::Make(schema_, arrays[0]->length(), arrays));
+  }
+
+  // Starts reading batches until `prefetch_` of them are in flight. The
+  // ColumnReaders are stateful, so every task waits for the one before it.
+  void Prefetch() {
+    while (!finished_ && static_cast<int>(pending_.size()) < prefetch_) {
+      std::shared_future<BatchResult> previous;
+      if (!pending_.empty()) {
+        previous = pending_.back();
+      }
+      pending_.push_back(std::async(std::launch::async, [this, previous]() {
+                           if (previous.valid()) {
+                             const BatchResult& result = previous.get();
+                             if (!result.first.ok() || !result.second) {
+                               return BatchResult(arrow::Status::OK(), nullptr);
+                             }
+                           }
+                           return ReadBatch();
+                         }).share());
+    }
+  }
+
+  std::unique_ptr<parquet::arrow::FileReader> reader_;
+  std::shared_ptr<arrow::Schema> schema_;
+  std::vector<std::unique_ptr<parquet::arrow::ColumnReader>> columns_;
+  int64_t batch_size_;
+  int prefetch_;
+  bool finished_;
+  // Destroyed before the readers, waiting for the batches still being read
+  std::deque<std::shared_future<BatchResult>> pending_;
+};
+
+void read_streaming(int64_t batch_size, int prefetch) {
+  std::cout << "Streaming parquet-arrow-example.parquet in batches of " << batch_size
+            << " rows" << std::endl;
+  std::shared_ptr<arrow::io::ReadableFile> infile;
+  PARQUET_THROW_NOT_OK(arrow::io::ReadableFile::Open(
+      "parquet-arrow-example.parquet", arrow::default_memory_pool(), &infile));
+
+  std::unique_ptr<parquet::arrow::FileReader> reader;
+  PARQUET_THROW_NOT_OK(
+      parquet::arrow::OpenFile(infile, arrow::default_memory_pool(), &reader));
+  std::shared_ptr<arrow::RecordBatchReader> batch_reader =
+      std::make_shared<StreamingBatchReader>(std::move(reader), batch_size, prefetch);
+
+  int64_t num_batches = 0;
+  int64_t num_rows = 0;
+  std::shared_ptr<arrow::RecordBatch> batch;
+  while (true) {
+    PARQUET_THROW_NOT_OK(batch_reader->ReadNext(&batch));
+    if (!batch) {
+      break;
+    }
+    num_batches++;
+    num_rows += batch->num_rows();
+  }
+  std::cout << "Streamed " << num_rows << " rows in " << num_batches << " batches."
+            << std::endl;
+}
+
 int main(int argc, char** argv) {
   std::shared_ptr<arrow::Table> table = generate_table();
   write_parquet_file(*table);
@@ -131,4 +316,7 @@ int main(int argc, char** argv) {
   read_single_rowgroup();
   read_single_column();
   read_single_column_chunk();
+  read_whole_file_by_column_chunks(
+      std::max(1, static_cast<int>(std::thread::hardware_concurrency())));
+  read_streaming(2, 2);
 }
@@ -0,0 +1,634 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "file_merger.h"
+
+#include <algorithm>
+#include <deque>
+#include <future>
+#include <limits>
+#include <map>
+#include <sstream>
+
+#include "arrow/buffer.h"
+#include "arrow/io/file.h"
+#include "arrow/io/memory.h"
+#include "arrow/util/thread-pool.h"
+
+#include "parquet/column_reader.h"
+#include "parquet/column_writer.h"
+#include "parquet/exception.h"
+#include "parquet/file_reader.h"
+#include "parquet/file_writer.h"
+#include "parquet/properties.h"
+#include "parquet/statistics.h"
+
+namespace parquet {
+namespace tools {
+
+static constexpr uint8_t PARQUET_MAGIC[4] = {'P', 'A', 'R', '1'};
+
+int64_t ColumnChunkStart(const ColumnChunkMetaData& column) {
+  // Same range computation as SerializedRowGroup::GetColumnPageReader
+  int64_t start = column.data_page_offset();
+  if (column.has_dictionary_page() && column.dictionary_page_offset() > 0 &&
+      start > column.dictionary_page_offset()) {
+    start = column.dictionary_page_offset();
+  }
+  return start;
+}
+
+bool HasDictionaryPages(const RowGroupMetaData& row_group) {
+  for (int i = 0; i < row_group.num_columns(); ++i) {
+    if (row_group.ColumnChunk(i)->has_dictionary_page()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+std::vector<Compression::type> ColumnCodecs(const FileMetaData& file) {
+  std::vector<Compression::type> codecs(file.schema()->num_columns(),
+                                        Compression::UNCOMPRESSED);
+  if (file.num_row_groups() > 0) {
+    std::unique_ptr<RowGroupMetaData> row_group = file.RowGroup(0);
+    for (int i = 0; i < row_group->num_columns(); ++i) {
+      codecs[i] = row_group->ColumnChunk(i)->compression();
+    }
+  }
+  return codecs;
+}
+
+bool HasReliableColumnChunkSizes(const FileMetaData& file) {
+  // Before PARQUET-816, parquet-cpp left the dictionary page header out of
+  // total_compressed_size. The core reader pads its reads for those files;
+  // a verbatim copy would cut the chunks short under a new created_by, so
+  // readers of the copy would not pad them either.
+  return !file.writer_version().VersionLt(
+      ApplicationVersion::PARQUET_816_FIXED_VERSION());
+}
+
+void CheckColumnChunkSizes(const FileMetaData& file) {
+  if (!HasReliableColumnChunkSizes(file)) {
+    throw ParquetException("Column chunk sizes written by '" + file.created_by() +
+                           "' are unreliable, the file has to be rewritten "
+                           "with parquet-rewrite first");
+  }
+}
+
+std::shared_ptr<FileMetaData> ReadFileFooter(const std::string& path) {
+  std::shared_ptr<::arrow::io::ReadableFile> file;
+  PARQUET_THROW_NOT_OK(::arrow::io::ReadableFile::Open(path, &file));
+  std::shared_ptr<FileMetaData> metadata = ReadMetaData(file);
+  PARQUET_THROW_NOT_OK(file->Close());
+  return metadata;
+}
+
+std::shared_ptr<Buffer> ReadRange(::arrow::io::RandomAccessFile* file, int64_t position,
+                                  int64_t nbytes) {
+  std::shared_ptr<Buffer> buffer;
+  PARQUET_THROW_NOT_OK(file->ReadAt(position, nbytes, &buffer));
+  if (buffer->size() < nbytes) {
+    std::stringstream ss;
+    ss << "Could not read " << nbytes << " bytes at offset " << position
+       << ", the file is truncated";
+    throw ParquetException(ss.str());
+  }
+  return buffer;
+}
+
+std::shared_ptr<Buffer> ReadColumnChunk(::arrow::io::RandomAccessFile* file,
+                                        const ColumnChunkMetaData& column) {
+  return ReadRange(file, ColumnChunkStart(column), column.total_compressed_size());
+}
+
+std::shared_ptr<RawRowGroup> ReadRawRowGroup(
+    ::arrow::io::RandomAccessFile* file,
+    const std::shared_ptr<FileMetaData>& file_metadata, int row_group) {
+  CheckColumnChunkSizes(*file_metadata);
+  auto out = std::make_shared<RawRowGroup>();
+  out->file_metadata = file_metadata;
+  out->metadata = file_metadata->RowGroup(row_group);
+
+  const int num_columns = out->metadata->num_columns();
+  std::vector<int64_t> starts(num_columns);
+  std::vector<int64_t> lengths(num_columns);
+  int64_t range_start = std::numeric_limits<int64_t>::max();
+  int64_t range_end = 0;
+  int64_t total_length = 0;
+  for (int i = 0; i < num_columns; ++i) {
+    auto column = out->metadata->ColumnChunk(i);
+    starts[i] = ColumnChunkStart(*column);
+    lengths[i] = column->total_compressed_size();
+    range_start = std::min(range_start, starts[i]);
+    range_end = std::max(range_end, starts[i] + lengths[i]);
+    total_length += lengths[i];
+  }
+
+  out->chunks.resize(num_columns);
+  if (num_columns > 0 && range_end - range_start == total_length) {
+    // Writers lay out the chunks of a row group back to back, so a single
+    // read covers all of them
+    std::shared_ptr<Buffer> data = ReadRange(file, range_start, total_length);
+    for (int i = 0; i < num_columns; ++i) {
+      out->chunks[i] = ::arrow::SliceBuffer(data, starts[i] - range_start, lengths[i]);
+    }
+  } else {
+    for (int i = 0; i < num_columns; ++i) {
+      out->chunks[i] = ReadRange(file, starts[i], lengths[i]);
+    }
+  }
+  return out;
+}
+
+// ----------------------------------------------------------------------
+// Statistics of concatenated column chunks
+
+template <typename DType>
+static std::shared_ptr<RowGroupStatistics> MergeTypedStatistics(
+    const ColumnDescriptor* descr,
+    const std::vector<std::shared_ptr<RowGroupStatistics>>& parts) {
+  auto merged = std::make_shared<TypedRowGroupStatistics<DType>>(descr);
+  for (const auto& part : parts) {
+    merged->Merge(static_cast<const TypedRowGroupStatistics<DType>&>(*part));
+  }
+  return merged;
+}
+
+static std::shared_ptr<RowGroupStatistics> MergeStatistics(
+    const ColumnDescriptor* descr,
+    const std::vector<std::shared_ptr<RowGroupStatistics>>& parts) {
+  for (const auto& part : parts) {
+    if (!part) {
+      return nullptr;
+    }
+  }
+  if (parts.size() == 1) {
+    return parts[0];
+  }
+  switch (descr->physical_type()) {
+    case Type::BOOLEAN:
+      return MergeTypedStatistics<BooleanType>(descr, parts);
+    case Type::INT32:
+      return MergeTypedStatistics<Int32Type>(descr, parts);
+    case Type::INT64:
+      return MergeTypedStatistics<Int64Type>(descr, parts);
+    case Type::FLOAT:
+      return MergeTypedStatistics<FloatType>(descr, parts);
+    case Type::DOUBLE:
+      return MergeTypedStatistics<DoubleType>(descr, parts);
+    case Type::BYTE_ARRAY:
+      return MergeTypedStatistics<ByteArrayType>(descr, parts);
+    case Type::FIXED_LEN_BYTE_ARRAY:
+      return MergeTypedStatistics<FLBAType>(descr, parts);
+    default:
+      // INT96 has no defined sort order
+      return nullptr;
+  }
+}
+
+// ----------------------------------------------------------------------
+// RawFileWriter
+
+RawFileWriter::RawFileWriter(const std::shared_ptr<::arrow::io::OutputStream>& sink,
+                             const std::shared_ptr<FileMetaData>& prototype)
+    : prototype_(prototype),
+      schema_(prototype->schema()),
+      sink_(new ArrowOutputStream(sink)),
+      num_row_groups_(0) {
+  codecs_ = ColumnCodecs(*prototype);
+  metadata_ = FileMetaDataBuilder::Make(schema_, PrototypeProperties(*prototype),
+                                        prototype->key_value_metadata());
+  sink_->Write(PARQUET_MAGIC, 4);
+}
+
+int64_t WriteRawColumnChunk(const ColumnDescriptor* descr,
+                            const std::vector<const ColumnChunkMetaData*>& columns,
+                            const std::vector<std::shared_ptr<Buffer>>& chunks,
+                            OutputStream* sink, ColumnChunkMetaDataBuilder* metadata) {
+  int64_t num_values = 0;
+  int64_t dictionary_page_offset = 0;
+  int64_t data_page_offset = -1;
+  int64_t compressed_size = 0;
+  int64_t uncompressed_size = 0;
+  bool has_dictionary = false;
+  std::vector<std::shared_ptr<RowGroupStatistics>> statistics;
+
+  for (size_t i = 0; i < columns.size(); ++i) {
+    const ColumnChunkMetaData& column = *columns[i];
+    if (column.has_dictionary_page()) {
+      if (columns.size() > 1) {
+        throw ParquetException(
+            "Column chunks with dictionary pages cannot be concatenated");
+      }
+      has_dictionary = true;
+    }
+
+    // Pages keep their position relative to the start of the chunk
+    const int64_t source_start = ColumnChunkStart(column);
+    const int64_t position = sink->Tell();
+    if (column.has_dictionary_page()) {
+      dictionary_page_offset =
+          position + (column.dictionary_page_offset() - source_start);
+    }
+    if (data_page_offset < 0) {
+      data_page_offset = position + (column.data_page_offset() - source_start);
+    }
+
+    sink->Write(chunks[i]->data(), chunks[i]->size());
+
+    num_values += column.num_values();
+    compressed_size += chunks[i]->size();
+    uncompressed_size += column.total_uncompressed_size();
+    statistics.push_back(column.is_stats_set() ? column.statistics() : nullptr);
+  }
+
+  std::shared_ptr<RowGroupStatistics> chunk_statistics =
+      MergeStatistics(descr, statistics);
+  if (chunk_statistics) {
+    metadata->SetStatistics(SortOrder::SIGNED == descr->sort_order(),
+                            chunk_statistics->Encode());
+  }
+  // The encodings list is derived from has_dictionary; the page headers
+  // still carry the exact encoding of every page.
+  metadata->Finish(num_values, dictionary_page_offset, -1, data_page_offset,
+                   compressed_size, uncompressed_size, has_dictionary, false);
+  return compressed_size;
+}
+
+void RawFileWriter::AppendRowGroup(
+    const std::vector<std::shared_ptr<RawRowGroup>>& parts) {
+  RowGroupMetaDataBuilder* rg_metadata = metadata_->AppendRowGroup();
+  int64_t num_rows = 0;
+  for (const auto& part : parts) {
+    num_rows += part->metadata->num_rows();
+  }
+  rg_metadata->set_num_rows(num_rows);
+
+  int64_t total_bytes_written = 0;
+  for (int i = 0; i < schema_->num_columns(); ++i) {
+    const ColumnDescriptor* descr = schema_->Column(i);
+    std::vector<std::unique_ptr<ColumnChunkMetaData>> owned_columns;
+    std::vector<const ColumnChunkMetaData*> columns;
+    std::vector<std::shared_ptr<Buffer>> chunks;
+    for (const auto& part : parts) {
+      owned_columns.push_back(part->metadata->ColumnChunk(i));
+      if (owned_columns.back()->compression() != codecs_[i]) {
+        std::stringstream ss;
+        ss << "Column " << descr->path()->ToDotString()
+           << " uses a different compression codec than the output file";
+        throw ParquetException(ss.str());
+      }
+      columns.push_back(owned_columns.back().get());
+      chunks.push_back(part->chunks[i]);
+    }
+    total_bytes_written += WriteRawColumnChunk(descr, columns, chunks, sink_.get(),
+                                               rg_metadata->NextColumnChunk());
+  }
+  rg_metadata->Finish(total_bytes_written);
+  num_row_groups_++;
+}
+
+int64_t RawFileWriter::Close() {
+  std::unique_ptr<FileMetaData> metadata = metadata_->Finish();
+  WriteFileMetaData(*metadata, sink_.get());
+  const int64_t file_size = sink_->Tell();
+  sink_->Close();
+  return file_size;
+}
+
+// ----------------------------------------------------------------------
+// Re-encoding of undersized row groups
+
+static constexpr int64_t kReencodeBatchSize = 4096;
+
+template <typename DType>
+static void CopyTypedColumn(ColumnReader* column_reader, ColumnWriter* column_writer) {
+  using T = typename DType::c_type;
+  auto reader = static_cast<TypedColumnReader<DType>*>(column_reader);
+  auto writer = static_cast<TypedColumnWriter<DType>*>(column_writer);
+
+  std::vector<int16_t> def_levels(kReencodeBatchSize);
+  std::vector<int16_t> rep_levels(kReencodeBatchSize);
+  std::unique_ptr<T[]> values(new T[kReencodeBatchSize]);
+  while (reader->HasNext()) {
+    int64_t values_read = 0;
+    int64_t levels_read =
+        reader->ReadBatch(kReencodeBatchSize, def_levels.data(), rep_levels.data(),
+                          values.get(), &values_read);
+    // BYTE_ARRAY and FLBA values point into the current page, so they have to
+    // be handed to the writer before the next ReadBatch call
+    writer->WriteBatch(levels_read, def_levels.data(), rep_levels.data(), values.get());
+  }
+}
+
+void CopyColumnValues(ColumnReader* reader, ColumnWriter* writer) {
+  switch (reader->descr()->physical_type()) {
+    case Type::BOOLEAN:
+      return CopyTypedColumn<BooleanType>(reader, writer);
+    case Type::INT32:
+      return CopyTypedColumn<Int32Type>(reader, writer);
+    case Type::INT64:
+      return CopyTypedColumn<Int64Type>(reader, writer);
+    case Type::INT96:
+      return CopyTypedColumn<Int96Type>(reader, writer);
+    case Type::FLOAT:
+      return CopyTypedColumn<FloatType>(reader, writer);
+    case Type::DOUBLE:
+      return CopyTypedColumn<DoubleType>(reader, writer);
+    case Type::BYTE_ARRAY:
+      return CopyTypedColumn<ByteArrayType>(reader, writer);
+    case Type::FIXED_LEN_BYTE_ARRAY:
+      return CopyTypedColumn<FLBAType>(reader, writer);
+    default:
+      throw ParquetException("Unsupported physical type");
+  }
+}
+
+std::shared_ptr<WriterProperties> PrototypeProperties(const FileMetaData& prototype) {
+  WriterProperties::Builder builder;
+  builder.version(prototype.version());
+  const std::vector<Compression::type> codecs = ColumnCodecs(prototype);
+  for (int i = 0; i < prototype.schema()->num_columns(); ++i) {
+    builder.compression(prototype.schema()->Column(i)->path(), codecs[i]);
+  }
+  return builder.build();
+}
+
+namespace {
+
+// A row group of an input file
+struct RowGroupSource {
+  std::string path;
+  std::shared_ptr<FileMetaData> footer;
+  int row_group;
+};
+
+}  // namespace
+
+// Decodes the source row groups and encodes them again as a single row group
+// of an in-memory file, which is then handed out like any copied row group
+static std::shared_ptr<RawRowGroup> ReencodeRowGroups(
+    const std::vector<RowGroupSource>& sources,
+    const std::shared_ptr<WriterProperties>& properties) {
+  const SchemaDescriptor* schema = sources[0].footer->schema();
+
+  std::map<std::string, std::unique_ptr<ParquetFileReader>> readers;
+  for (const RowGroupSource& source : sources) {
+    if (readers.find(source.path) == readers.end()) {
+      readers[source.path] = ParquetFileReader::OpenFile(
+          source.path, false, default_reader_properties(), source.footer);
+    }
+  }
+
+  std::shared_ptr<::arrow::io::BufferOutputStream> sink;
+  PARQUET_THROW_NOT_OK(::arrow::io::BufferOutputStream::Create(
+      0, properties->memory_pool(), &sink));
+  std::unique_ptr<ParquetFileWriter> file_writer = ParquetFileWriter::Open(
+      sink, std::static_pointer_cast<schema::GroupNode>(schema->schema_root()),
+      properties);
+  RowGroupWriter* rg_writer = file_writer->AppendRowGroup();
+  for (int i = 0; i < schema->num_columns(); ++i) {
+    ColumnWriter* column_writer = rg_writer->NextColumn();
+    for (const RowGroupSource& source : sources) {
+      std::shared_ptr<ColumnReader> column_reader =
+          readers[source.path]->RowGroup(source.row_group)->Column(i);
+      CopyColumnValues(column_reader.get(), column_writer);
+    }
+  }
+  file_writer->Close();
+
+  std::shared_ptr<Buffer> buffer;
+  PARQUET_THROW_NOT_OK(sink->Finish(&buffer));
+  auto file = std::make_shared<::arrow::io::BufferReader>(buffer);
+  return ReadRawRowGroup(file.get(), ReadMetaData(file), 0);
+}
+
+// ----------------------------------------------------------------------
+// MergeFiles
+
+static int64_t CompressedSize(const RowGroupMetaData& row_group) {
+  int64_t size = 0;
+  for (int i = 0; i < row_group.num_columns(); ++i) {
+    size += row_group.ColumnChunk(i)->total_compressed_size();
+  }
+  return size;
+}
+
+// Upper bound on the input bytes of the merge items in flight
+static constexpr int64_t kMaxPendingBytes = 256 * 1024 * 1024;
+
+namespace {
+
+// One output row group: either source row groups whose column chunks are
+// concatenated verbatim, or a run of small ones that is re-encoded
+struct MergeItem {
+  bool reencode = false;
+  // Input file and row group indices
+  std::vector<std::pair<int, int>> sources;
+};
+
+}  // namespace
+
+MergeStats MergeFiles(const std::vector<std::string>& paths,
+                      const std::shared_ptr<::arrow::io::OutputStream>& sink,
+                      const MergeOptions& options) {
+  if (paths.empty()) {
+    throw ParquetException("No input files to merge");
+  }
+  std::shared_ptr<::arrow::internal::ThreadPool> pool;
+  PARQUET_THROW_NOT_OK(
+      ::arrow::internal::ThreadPool::Make(std::max(options.num_threads, 1), &pool));
+
+  // Footers are small, so read all of them up front and in parallel
+  std::vector<std::future<std::shared_ptr<FileMetaData>>> footer_futures;
+  for (const std::string& path : paths) {
+    footer_futures.push_back(pool->Submit(ReadFileFooter, path));
+  }
+  std::vector<std::shared_ptr<FileMetaData>> footers;
+  for (auto& footer : footer_futures) {
+    footers.push_back(footer.get());
+  }
+
+  std::shared_ptr<FileMetaData> prototype = footers[0];
+  for (size_t i = 0; i < footers.size(); ++i) {
+    if (!footers[i]->schema()->Equals(*footers[0]->schema())) {
+      throw ParquetException(paths[i] + ": schema differs from " + paths[0]);
+    }
+    if (prototype->num_row_groups() == 0) {
+      prototype = footers[i];
+    }
+  }
+
+  // Plan the output row groups from the footers alone
+  MergeStats stats;
+  const int64_t row_group_size =
+      options.row_group_size > 0 ? options.row_group_size : kDefaultRowGroupSize;
+  std::vector<MergeItem> items;
+  MergeItem group;
+  int64_t group_bytes = 0;
+  MergeItem run;
+  run.reencode = true;
+  int64_t run_bytes = 0;
+
+  auto flush_group = [&]() {
+    if (!group.sources.empty()) {
+      items.push_back(group);
+    }
+    group.sources.clear();
+    group_bytes = 0;
+  };
+  auto flush_run = [&]() {
+    if (run.sources.size() == 1) {
+      // Re-encoding a lone row group would not make it any larger
+      MergeItem copy;
+      copy.sources = run.sources;
+      items.push_back(copy);
+    } else if (!run.sources.empty()) {
+      items.push_back(run);
+    }
+    run.sources.clear();
+    run_bytes = 0;
+  };
+
+  for (size_t i = 0; i < footers.size(); ++i) {
+    for (int r = 0; r < footers[i]->num_row_groups(); ++r) {
+      std::unique_ptr<RowGroupMetaData> row_group = footers[i]->RowGroup(r);
+      const std::pair<int, int> source(static_cast<int>(i), r);
+      const int64_t size = CompressedSize(*row_group);
+      stats.num_input_row_groups++;
+      stats.num_rows += row_group->num_rows();
+
+      if (options.coalesce_threshold > 0 && size < options.coalesce_threshold) {
+        flush_group();
+        if (run_bytes + size > row_group_size) {
+          flush_run();
+        }
+        run.sources.push_back(source);
+        run_bytes += size;
+        continue;
+      }
+      flush_run();
+
+      const bool groupable = options.group_size > 0 && !HasDictionaryPages(*row_group);
+      if (!groupable || group_bytes + size > options.group_size) {
+        flush_group();
+      }
+      group.sources.push_back(source);
+      group_bytes += size;
+      if (!groupable) {
+        flush_group();
+      }
+    }
+  }
+  flush_run();
+  flush_group();
+
+  // Row groups that are copied verbatim must be copyable into the output,
+  // which is checked before anything is written
+  const std::vector<Compression::type> codecs = ColumnCodecs(*prototype);
+  for (const MergeItem& item : items) {
+    for (const auto& source : item.sources) {
+      std::unique_ptr<RowGroupMetaData> row_group =
+          footers[source.first]->RowGroup(source.second);
+      const int64_t size = CompressedSize(*row_group);
+      if (item.reencode) {
+        stats.num_reencoded_row_groups++;
+        stats.bytes_reencoded += size;
+        continue;
+      }
+      stats.bytes_copied += size;
+      try {
+        CheckColumnChunkSizes(*footers[source.first]);
+      } catch (const ParquetException& e) {
+        throw ParquetException(paths[source.first] + ": " + e.what());
+      }
+      for (int i = 0; i < row_group->num_columns(); ++i) {
+        if (row_group->ColumnChunk(i)->compression() != codecs[i]) {
+          std::stringstream ss;
+          ss << paths[source.first] << ": column "
+             << prototype->schema()->Column(i)->path()->ToDotString()
+             << " uses a different compression codec than " << paths[0];
+          throw ParquetException(ss.str());
+        }
+      }
+    }
+  }
+
+  // Items are processed ahead of the writer as long as the row groups they
+  // read add up to at most kMaxPendingBytes, which bounds the memory held by
+  // in-flight column chunks and re-encoded row groups
+  std::shared_ptr<WriterProperties> properties = PrototypeProperties(*prototype);
+  std::deque<std::future<std::vector<std::shared_ptr<RawRowGroup>>>> pending;
+  std::deque<int64_t> pending_sizes;
+  int64_t pending_bytes = 0;
+  size_t next_item = 0;
+  auto submit_items = [&]() {
+    while (next_item < items.size()) {
+      const MergeItem& item = items[next_item];
+      int64_t item_bytes = 0;
+      for (const auto& source : item.sources) {
+        item_bytes += CompressedSize(*footers[source.first]->RowGroup(source.second));
+      }
+      // A single item larger than the limit is still processed on its own
+      if (!pending.empty() && pending_bytes + item_bytes > kMaxPendingBytes) {
+        break;
+      }
+      next_item++;
+      pending_sizes.push_back(item_bytes);
+      pending_bytes += item_bytes;
+      std::vector<RowGroupSource> sources;
+      for (const auto& source : item.sources) {
+        sources.push_back({paths[source.first], footers[source.first], source.second});
+      }
+      if (item.reencode) {
+        pending.push_back(pool->Submit([sources, properties]() {
+          return std::vector<std::shared_ptr<RawRowGroup>>{
+              ReencodeRowGroups(sources, properties)};
+        }));
+        continue;
+      }
+      pending.push_back(pool->Submit([sources]() {
+        std::vector<std::shared_ptr<RawRowGroup>> parts;
+        for (const RowGroupSource& source : sources) {
+          std::shared_ptr<::arrow::io::ReadableFile> file;
+          PARQUET_THROW_NOT_OK(::arrow::io::ReadableFile::Open(source.path, &file));
+          parts.push_back(ReadRawRowGroup(file.get(), source.footer, source.row_group));
+          PARQUET_THROW_NOT_OK(file->Close());
+        }
+        return parts;
+      }));
+    }
+  };
+
+  RawFileWriter writer(sink, prototype);
+  submit_items();
+  while (!pending.empty()) {
+    std::vector<std::shared_ptr<RawRowGroup>> parts = pending.front().get();
+    pending.pop_front();
+    pending_bytes -= pending_sizes.front();
+    pending_sizes.pop_front();
+    submit_items();
+    writer.AppendRowGroup(parts);
+  }
+  writer.Close();
+  stats.num_output_row_groups = writer.num_row_groups();
+  return stats;
+}
+
+}  // namespace tools
+}  // namespace parquet
@@ -0,0 +1,175 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#ifndef PARQUET_TOOLS_FILE_MERGER_H
+#define PARQUET_TOOLS_FILE_MERGER_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "arrow/io/interfaces.h"
+
+#include "parquet/column_reader.h"
+#include "parquet/column_writer.h"
+#include "parquet/metadata.h"
+#include "parquet/properties.h"
+#include "parquet/types.h"
+#include "parquet/util/memory.h"
+
+namespace parquet {
+namespace tools {
+
+// The compressed column chunks of a single row group, exactly as they are
+// stored in their source file.
+struct RawRowGroup {
+  // Keeps the thrift structures referenced by `metadata` alive
+  std::shared_ptr<FileMetaData> file_metadata;
+  std::unique_ptr<RowGroupMetaData> metadata;
+  // One buffer per leaf column, starting at the dictionary page (if any)
+  std::vector<std::shared_ptr<Buffer>> chunks;
+};
+
+// Returns the file offset of the first page of a column chunk
+int64_t ColumnChunkStart(const ColumnChunkMetaData& column);
+
+// Returns true if any column chunk of the row group starts with a dictionary page
+bool HasDictionaryPages(const RowGroupMetaData& row_group);
+
+// Returns the codec of every leaf column in the first row group of `file`
+std::vector<Compression::type> ColumnCodecs(const FileMetaData& file);
+
+// Returns writer properties that use the codecs of `prototype` for every column
+std::shared_ptr<WriterProperties> PrototypeProperties(const FileMetaData& prototype);
+
+// Returns false if the column chunk sizes recorded by the writer of `file` do
+// not cover the whole chunk, so that its chunks cannot be copied verbatim
+bool HasReliableColumnChunkSizes(const FileMetaData& file);
+
+// Throws unless HasReliableColumnChunkSizes(file)
+void CheckColumnChunkSizes(const FileMetaData& file);
+
+// Reads the footer of the file at `path`
+std::shared_ptr<FileMetaData> ReadFileFooter(const std::string& path);
+
+// Reads exactly `nbytes` bytes at `position`, throwing if the file is shorter
+std::shared_ptr<Buffer> ReadRange(::arrow::io::RandomAccessFile* file, int64_t position,
+                                  int64_t nbytes);
+
+// Reads the compressed bytes of a single column chunk
+std::shared_ptr<Buffer> ReadColumnChunk(::arrow::io::RandomAccessFile* file,
+                                        const ColumnChunkMetaData& column);
+
+// Reads the column chunks of a row group without decompressing them. Throws
+// if the file fails CheckColumnChunkSizes.
+std::shared_ptr<RawRowGroup> ReadRawRowGroup(
+    ::arrow::io::RandomAccessFile* file,
+    const std::shared_ptr<FileMetaData>& file_metadata, int row_group);
+
+// Decodes all remaining values (and levels) of `reader` and writes them to
+// `writer`, which must be a column of the same physical type
+void CopyColumnValues(ColumnReader* reader, ColumnWriter* writer);
+
+// Writes the given column chunks back to back to `sink` and records them,
+// with their page offsets moved to the new position, in `metadata`. Returns
+// the number of bytes written.
+int64_t WriteRawColumnChunk(const ColumnDescriptor* descr,
+                            const std::vector<const ColumnChunkMetaData*>& columns,
+                            const std::vector<std::shared_ptr<Buffer>>& chunks,
+                            OutputStream* sink, ColumnChunkMetaDataBuilder* metadata);
+
+// Assembles a Parquet file out of column chunks copied verbatim from other
+// files. Only the page offsets stored in the footer are rewritten.
+//
+// The schema, key/value metadata and per-column compression codecs are taken
+// over from `prototype`; every appended column chunk must use the same codec.
+class RawFileWriter {
+ public:
+  RawFileWriter(const std::shared_ptr<::arrow::io::OutputStream>& sink,
+                const std::shared_ptr<FileMetaData>& prototype);
+
+  // Appends one row group made of the concatenated column chunks of `parts`.
+  // Pages are self-contained, so chunks can be concatenated as long as none
+  // of them (apart from a single-part row group) carries a dictionary page.
+  void AppendRowGroup(const std::vector<std::shared_ptr<RawRowGroup>>& parts);
+
+  // Writes the footer and closes the sink. Returns the size of the file.
+  int64_t Close();
+
+  int num_row_groups() const { return num_row_groups_; }
+
+ private:
+  std::shared_ptr<FileMetaData> prototype_;
+  const SchemaDescriptor* schema_;
+  std::vector<Compression::type> codecs_;
+  std::unique_ptr<OutputStream> sink_;
+  std::unique_ptr<FileMetaDataBuilder> metadata_;
+  int num_row_groups_;
+};
+
+constexpr int64_t kDefaultRowGroupSize = 128 * 1024 * 1024;
+
+struct MergeOptions {
+  // Number of threads used to read footers and copy or re-encode row groups
+  int num_threads = 1;
+  // When positive, adjacent row groups without dictionary pages are
+  // concatenated into one output row group while their total compressed
+  // size stays within this many bytes.
+  int64_t group_size = 0;
+  // When positive, runs of adjacent row groups whose compressed size is
+  // below this many bytes are decoded and re-encoded into row groups of
+  // about `row_group_size` bytes. Larger row groups are still copied verbatim.
+  int64_t coalesce_threshold = 0;
+  // Target compressed size of re-encoded row groups, kDefaultRowGroupSize if
+  // not positive
+  int64_t row_group_size = 0;
+  // Leaf column indices that MergeSortedFiles orders the rows by
+  std::vector<int> sort_columns;
+};
+
+struct MergeStats {
+  int64_t num_input_row_groups = 0;
+  int64_t num_output_row_groups = 0;
+  int64_t num_rows = 0;
+  // Compressed bytes of the input row groups that were copied verbatim
+  int64_t bytes_copied = 0;
+  // Compressed bytes of the input row groups that were decoded and re-encoded
+  int64_t bytes_reencoded = 0;
+  int64_t num_reencoded_row_groups = 0;
+};
+
+// Appends all row groups of `paths` to a new file written to `sink`. The
+// inputs must share the same schema and per-column codecs.
+MergeStats MergeFiles(const std::vector<std::string>& paths,
+                      const std::shared_ptr<::arrow::io::OutputStream>& sink,
+                      const MergeOptions& options);
+
+// Merges inputs that are each sorted by `options.sort_columns` into one file
+// sorted by the same columns. All inputs are streamed at once through a
+// k-way merge, holding a single batch of rows per input and column. Only
+// schemas without repeated fields are supported. Keys compare in the sort
+// order of their column; nulls sort first and NaNs after all numbers. Throws
+// if an input turns out not to be sorted.
+MergeStats MergeSortedFiles(const std::vector<std::string>& paths,
+                            const std::shared_ptr<::arrow::io::OutputStream>& sink,
+                            const MergeOptions& options);
+
+}  // namespace tools
+}  // namespace parquet
+
+#endif  // PARQUET_TOOLS_FILE_MERGER_H
@@ -0,0 +1,405 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "file_rewriter.h"
+
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <future>
+#include <sstream>
+#include <vector>
+
+#include "arrow/io/file.h"
+#include "arrow/util/compression.h"
+#include "arrow/util/thread-pool.h"
+
+#include "parquet/column_page.h"
+#include "parquet/column_reader.h"
+#include "parquet/column_writer.h"
+#include "parquet/exception.h"
+#include "parquet/file_reader.h"
+#include "parquet/file_writer.h"
+#include "parquet/metadata.h"
+#include "parquet/properties.h"
+#include "parquet/util/memory.h"
+
+#include "file_merger.h"
+
+namespace parquet {
+namespace tools {
+
+namespace {
+
+constexpr uint8_t PARQUET_MAGIC[4] = {'P', 'A', 'R', '1'};
+
+// The pages of a rewritten column chunk, ready to be handed to a PageWriter.
+// Data pages are already compressed with the output codec, dictionary pages
+// are not since PageWriter::WriteDictionaryPage compresses them itself.
+// Unchanged chunks are carried as their raw bytes instead.
+struct RewrittenChunk {
+  std::shared_ptr<Buffer> raw;
+  std::vector<std::shared_ptr<Page>> pages;
+  bool has_dictionary = false;
+  bool fallback = false;
+};
+
+// Page buffers returned by PageReader are reused for the next page, so every
+// page that is kept has to be copied or compressed into a buffer of its own
+std::shared_ptr<Buffer> CopyBuffer(const uint8_t* data, int64_t size,
+                                   ::arrow::MemoryPool* pool) {
+  std::shared_ptr<ResizableBuffer> out = AllocateBuffer(pool, size);
+  std::memcpy(out->mutable_data(), data, static_cast<size_t>(size));
+  return out;
+}
+
+class PageCompressor {
+ public:
+  PageCompressor(Compression::type codec, ::arrow::MemoryPool* pool)
+      : codec_(GetCodecFromArrow(codec)), pool_(pool) {}
+
+  bool has_compressor() const { return codec_ != nullptr; }
+
+  // Same as SerializedPageWriter::Compress
+  void Compress(const Buffer& src_buffer, ResizableBuffer* dest_buffer) {
+    int64_t max_compressed_size =
+        codec_->MaxCompressedLen(src_buffer.size(), src_buffer.data());
+    PARQUET_THROW_NOT_OK(dest_buffer->Resize(max_compressed_size, false));
+    int64_t compressed_size;
+    PARQUET_THROW_NOT_OK(codec_->Compress(src_buffer.size(), src_buffer.data(),
+                                          max_compressed_size,
+                                          dest_buffer->mutable_data(), &compressed_size));
+    PARQUET_THROW_NOT_OK(dest_buffer->Resize(compressed_size, false));
+  }
+
+  // Returns a compressed copy of a page payload
+  std::shared_ptr<Buffer> Compress(const uint8_t* data, int64_t size) {
+    if (codec_ == nullptr) {
+      return CopyBuffer(data, size, pool_);
+    }
+    std::shared_ptr<ResizableBuffer> out = AllocateBuffer(pool_, 0);
+    Compress(Buffer(data, size), out.get());
+    return out;
+  }
+
+ private:
+  std::unique_ptr<::arrow::util::Codec> codec_;
+  ::arrow::MemoryPool* pool_;
+};
+
+// A PageWriter that keeps the pages produced by a ColumnWriter in memory
+// instead of writing them, so that column chunks can be re-encoded on any
+// thread and written out in order afterwards
+class PageCollector : public PageWriter {
+ public:
+  PageCollector(Compression::type codec, ::arrow::MemoryPool* pool, RewrittenChunk* out)
+      : compressor_(codec, pool), pool_(pool), out_(out) {}
+
+  void Close(bool has_dictionary, bool fallback) override {
+    out_->has_dictionary = has_dictionary;
+    out_->fallback = fallback;
+  }
+
+  int64_t WriteDataPage(const CompressedDataPage& page) override {
+    out_->pages.push_back(std::make_shared<CompressedDataPage>(
+        CopyBuffer(page.data(), page.size(), pool_), page.num_values(), page.encoding(),
+        page.definition_level_encoding(), page.repetition_level_encoding(),
+        page.uncompressed_size(), page.statistics()));
+    return page.size();
+  }
+
+  int64_t WriteDictionaryPage(const DictionaryPage& page) override {
+    out_->pages.push_back(
+        std::make_shared<DictionaryPage>(CopyBuffer(page.data(), page.size(), pool_),
+                                         page.num_values(), page.encoding(),
+                                         page.is_sorted()));
+    return page.size();
+  }
+
+  bool has_compressor() override { return compressor_.has_compressor(); }
+
+  void Compress(const Buffer& src_buffer, ResizableBuffer* dest_buffer) override {
+    compressor_.Compress(src_buffer, dest_buffer);
+  }
+
+ private:
+  PageCompressor compressor_;
+  ::arrow::MemoryPool* pool_;
+  RewrittenChunk* out_;
+};
+
+// A column chunk of the input file
+struct ChunkSource {
+  std::string path;
+  std::shared_ptr<FileMetaData> footer;
+  int row_group;
+  int column;
+};
+
+std::unique_ptr<ParquetFileReader> OpenSource(const ChunkSource& source) {
+  return ParquetFileReader::OpenFile(source.path, false, default_reader_properties(),
+                                     source.footer);
+}
+
+std::shared_ptr<RewrittenChunk> CopyChunk(const ChunkSource& source) {
+  CheckColumnChunkSizes(*source.footer);
+  auto out = std::make_shared<RewrittenChunk>();
+  std::shared_ptr<::arrow::io::ReadableFile> file;
+  PARQUET_THROW_NOT_OK(::arrow::io::ReadableFile::Open(source.path, &file));
+  out->raw = ReadColumnChunk(
+      file.get(), *source.footer->RowGroup(source.row_group)->ColumnChunk(source.column));
+  PARQUET_THROW_NOT_OK(file->Close());
+  return out;
+}
+
+// Decompresses every page payload and compresses it again with `codec`,
+// keeping the encoding, levels and statistics of the page
+std::shared_ptr<RewrittenChunk> RecompressChunk(const ChunkSource& source,
+                                                Compression::type codec,
+                                                ::arrow::MemoryPool* pool) {
+  auto out = std::make_shared<RewrittenChunk>();
+  std::unique_ptr<ParquetFileReader> reader = OpenSource(source);
+  std::unique_ptr<PageReader> pages =
+      reader->RowGroup(source.row_group)->GetColumnPageReader(source.column);
+  PageCompressor compressor(codec, pool);
+
+  while (std::shared_ptr<Page> page = pages->NextPage()) {
+    if (page->type() == PageType::DICTIONARY_PAGE) {
+      const auto& dict_page = static_cast<const DictionaryPage&>(*page);
+      out->pages.push_back(std::make_shared<DictionaryPage>(
+          CopyBuffer(dict_page.data(), dict_page.size(), pool), dict_page.num_values(),
+          dict_page.encoding(), dict_page.is_sorted()));
+      out->has_dictionary = true;
+    } else if (page->type() == PageType::DATA_PAGE) {
+      const auto& data_page = static_cast<const DataPage&>(*page);
+      out->pages.push_back(std::make_shared<CompressedDataPage>(
+          compressor.Compress(data_page.data(), data_page.size()),
+          data_page.num_values(), data_page.encoding(),
+          data_page.definition_level_encoding(), data_page.repetition_level_encoding(),
+          data_page.size(), data_page.statistics()));
+      if (out->has_dictionary && data_page.encoding() == Encoding::PLAIN) {
+        out->fallback = true;
+      }
+    } else {
+      throw ParquetException("Only v1 data pages can be recompressed");
+    }
+  }
+  return out;
+}
+
+// Decodes the column chunk and encodes it again with `properties`
+std::shared_ptr<RewrittenChunk> ReencodeChunk(
+    const ChunkSource& source, Compression::type codec,
+    const std::shared_ptr<WriterProperties>& properties) {
+  auto out = std::make_shared<RewrittenChunk>();
+  std::unique_ptr<ParquetFileReader> reader = OpenSource(source);
+  std::shared_ptr<ColumnReader> column_reader =
+      reader->RowGroup(source.row_group)->Column(source.column);
+
+  // The column writer reports to a throwaway metadata builder; the real
+  // column chunk metadata is produced when the collected pages are written
+  std::unique_ptr<FileMetaDataBuilder> scratch =
+      FileMetaDataBuilder::Make(source.footer->schema(), properties);
+  RowGroupMetaDataBuilder* scratch_row_group = scratch->AppendRowGroup();
+  ColumnChunkMetaDataBuilder* scratch_column = nullptr;
+  for (int i = 0; i <= source.column; ++i) {
+    scratch_column = scratch_row_group->NextColumnChunk();
+  }
+
+  std::unique_ptr<PageWriter> pager(
+      new PageCollector(codec, properties->memory_pool(), out.get()));
+  std::shared_ptr<ColumnWriter> column_writer =
+      ColumnWriter::Make(scratch_column, std::move(pager), properties.get());
+  CopyColumnValues(column_reader.get(), column_writer.get());
+  column_writer->Close();
+  return out;
+}
+
+}  // namespace
+
+void CheckRewriteOptions(const SchemaDescriptor& schema, const RewriteOptions& options) {
+  auto check_column = [&schema](int column) {
+    if (column < 0 || column >= schema.num_columns()) {
+      std::stringstream ss;
+      ss << "Column " << column << " does not exist";
+      throw ParquetException(ss.str());
+    }
+  };
+  for (const auto& column_codec : options.column_codecs) {
+    check_column(column_codec.first);
+  }
+  for (const auto& column_encoding : options.column_encodings) {
+    check_column(column_encoding.first);
+    const ColumnDescriptor* descr = schema.Column(column_encoding.first);
+    std::stringstream ss;
+    ss << "Column " << descr->path()->ToDotString() << ": ";
+    // TypedColumnWriter implements PLAIN and dictionary encoding only
+    switch (column_encoding.second) {
+      case Encoding::PLAIN:
+        break;
+      case Encoding::PLAIN_DICTIONARY:
+      case Encoding::RLE_DICTIONARY:
+        if (descr->physical_type() == Type::BOOLEAN) {
+          ss << "BOOLEAN columns cannot be dictionary encoded";
+          throw ParquetException(ss.str());
+        }
+        break;
+      default:
+        ss << "only PLAIN and dictionary encoding can be written";
+        throw ParquetException(ss.str());
+    }
+  }
+}
+
+RewriteStats RewriteFile(const std::string& path,
+                         const std::shared_ptr<::arrow::io::OutputStream>& sink,
+                         const RewriteOptions& options) {
+  std::shared_ptr<FileMetaData> footer = ReadFileFooter(path);
+  const SchemaDescriptor* schema = footer->schema();
+  const int num_columns = schema->num_columns();
+
+  CheckRewriteOptions(*schema, options);
+
+  // The output codec of a column is fixed for all of its chunks
+  std::vector<Compression::type> codecs = ColumnCodecs(*footer);
+  if (options.set_codec) {
+    std::fill(codecs.begin(), codecs.end(), options.codec);
+  }
+  for (const auto& column_codec : options.column_codecs) {
+    codecs[column_codec.first] = column_codec.second;
+  }
+
+  WriterProperties::Builder builder;
+  builder.version(footer->version());
+  for (int i = 0; i < num_columns; ++i) {
+    builder.compression(schema->Column(i)->path(), codecs[i]);
+  }
+  for (const auto& column_encoding : options.column_encodings) {
+    const std::shared_ptr<schema::ColumnPath> column_path =
+        schema->Column(column_encoding.first)->path();
+    if (column_encoding.second == Encoding::PLAIN_DICTIONARY ||
+        column_encoding.second == Encoding::RLE_DICTIONARY) {
+      builder.enable_dictionary(column_path);
+    } else {
+      builder.disable_dictionary(column_path);
+      builder.encoding(column_path, column_encoding.second);
+    }
+  }
+  std::shared_ptr<WriterProperties> properties = builder.build();
+
+  std::shared_ptr<::arrow::internal::ThreadPool> pool;
+  PARQUET_THROW_NOT_OK(
+      ::arrow::internal::ThreadPool::Make(std::max(options.num_threads, 1), &pool));
+
+  // Chunks are processed ahead of the writer by at most a couple of tasks per
+  // thread, which bounds the memory held by rewritten pages
+  RewriteStats stats;
+  // Chunks of files with unreliable chunk sizes are read through the core
+  // reader, which pads for them, even when their codec does not change
+  const bool copyable = HasReliableColumnChunkSizes(*footer);
+  std::vector<ChunkSource> tasks;
+  for (int r = 0; r < footer->num_row_groups(); ++r) {
+    for (int i = 0; i < num_columns; ++i) {
+      tasks.push_back({path, footer, r, i});
+    }
+  }
+  const size_t max_pending = 2 * static_cast<size_t>(std::max(options.num_threads, 1));
+  std::deque<std::future<std::shared_ptr<RewrittenChunk>>> pending;
+  size_t next_task = 0;
+  auto submit_tasks = [&]() {
+    while (next_task < tasks.size() && pending.size() < max_pending) {
+      const ChunkSource& source = tasks[next_task++];
+      const Compression::type codec = codecs[source.column];
+      if (options.column_encodings.count(source.column) > 0) {
+        pending.push_back(pool->Submit([source, codec, properties]() {
+          return ReencodeChunk(source, codec, properties);
+        }));
+        stats.num_reencoded_chunks++;
+      } else if (copyable && source.footer->RowGroup(source.row_group)
+                                     ->ColumnChunk(source.column)
+                                     ->compression() == codec) {
+        pending.push_back(pool->Submit([source]() { return CopyChunk(source); }));
+        stats.num_copied_chunks++;
+      } else {
+        ::arrow::MemoryPool* memory_pool = properties->memory_pool();
+        pending.push_back(pool->Submit([source, codec, memory_pool]() {
+          return RecompressChunk(source, codec, memory_pool);
+        }));
+        stats.num_recompressed_chunks++;
+      }
+    }
+  };
+
+  std::unique_ptr<OutputStream> out(new ArrowOutputStream(sink));
+  out->Write(PARQUET_MAGIC, 4);
+  std::unique_ptr<FileMetaDataBuilder> metadata =
+      FileMetaDataBuilder::Make(schema, properties, footer->key_value_metadata());
+
+  submit_tasks();
+  for (int r = 0; r < footer->num_row_groups(); ++r) {
+    std::unique_ptr<RowGroupMetaData> row_group = footer->RowGroup(r);
+    RowGroupMetaDataBuilder* rg_metadata = metadata->AppendRowGroup();
+    rg_metadata->set_num_rows(row_group->num_rows());
+
+    int64_t total_bytes_written = 0;
+    for (int i = 0; i < num_columns; ++i) {
+      std::shared_ptr<RewrittenChunk> chunk = pending.front().get();
+      pending.pop_front();
+      submit_tasks();
+
+      const ColumnDescriptor* descr = schema->Column(i);
+      std::unique_ptr<ColumnChunkMetaData> column = row_group->ColumnChunk(i);
+      ColumnChunkMetaDataBuilder* col_metadata = rg_metadata->NextColumnChunk();
+      stats.bytes_read += column->total_compressed_size();
+      stats.num_column_chunks++;
+
+      if (chunk->raw) {
+        total_bytes_written += WriteRawColumnChunk(descr, {column.get()}, {chunk->raw},
+                                                   out.get(), col_metadata);
+        continue;
+      }
+
+      const int64_t start = out->Tell();
+      std::unique_ptr<PageWriter> pager = PageWriter::Open(
+          out.get(), codecs[i], col_metadata, properties->memory_pool());
+      for (const std::shared_ptr<Page>& page : chunk->pages) {
+        if (page->type() == PageType::DICTIONARY_PAGE) {
+          pager->WriteDictionaryPage(static_cast<const DictionaryPage&>(*page));
+        } else {
+          pager->WriteDataPage(static_cast<const CompressedDataPage&>(*page));
+        }
+      }
+      // The values are unchanged, so the statistics of the input still hold
+      if (column->is_stats_set()) {
+        col_metadata->SetStatistics(SortOrder::SIGNED == descr->sort_order(),
+                                    column->statistics()->Encode());
+      }
+      pager->Close(chunk->has_dictionary, chunk->fallback);
+      total_bytes_written += out->Tell() - start;
+    }
+    rg_metadata->Finish(total_bytes_written);
+  }
+
+  std::unique_ptr<FileMetaData> file_metadata = metadata->Finish();
+  WriteFileMetaData(*file_metadata, out.get());
+  stats.bytes_written = out->Tell();
+  out->Close();
+  return stats;
+}
+
+}  // namespace tools
+}  // namespace parquet
@@ -0,0 +1,83 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#ifndef PARQUET_TOOLS_FILE_REWRITER_H
+#define PARQUET_TOOLS_FILE_REWRITER_H
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+
+#include "arrow/io/interfaces.h"
+
+#include "parquet/schema.h"
+#include "parquet/types.h"
+
+namespace parquet {
+namespace tools {
+
+struct RewriteOptions {
+  // Number of threads used to recompress or re-encode column chunks
+  int num_threads = 1;
+  // Codec for the columns not listed in `column_codecs`. Unless
+  // `set_codec` is true, every column keeps the codec of its first chunk.
+  bool set_codec = false;
+  Compression::type codec = Compression::UNCOMPRESSED;
+  // Per leaf column overrides of `codec`
+  std::map<int, Compression::type> column_codecs;
+  // Leaf columns whose values are decoded and encoded again. PLAIN_DICTIONARY
+  // enables dictionary encoding, PLAIN disables it; the column writers
+  // implement no other encodings.
+  std::map<int, Encoding::type> column_encodings;
+};
+
+struct RewriteStats {
+  int64_t num_column_chunks = 0;
+  // Column chunks copied unchanged because neither codec nor encoding changed
+  int64_t num_copied_chunks = 0;
+  // Column chunks whose page payloads were decompressed and recompressed
+  int64_t num_recompressed_chunks = 0;
+  // Column chunks that were decoded and re-encoded
+  int64_t num_reencoded_chunks = 0;
+  int64_t bytes_read = 0;
+  int64_t bytes_written = 0;
+};
+
+// Throws if `options` names columns that `schema` lacks or encodings that
+// cannot be written for them
+void CheckRewriteOptions(const SchemaDescriptor& schema, const RewriteOptions& options);
+
+// Writes a copy of the file at `path` to `sink` with new compression codecs
+// and, optionally, new encodings for some columns.
+//
+// Recompressed column chunks are rewritten page by page: every page payload
+// is decompressed and compressed again with the new codec while its
+// encoding, levels and page statistics are kept. Column chunks are processed
+// in parallel and written in their original order. `options` are checked
+// with CheckRewriteOptions before anything is written.
+//
+// Files that fail CheckColumnChunkSizes are recompressed even where the codec
+// does not change, which makes their copy safe to merge or split.
+RewriteStats RewriteFile(const std::string& path,
+                         const std::shared_ptr<::arrow::io::OutputStream>& sink,
+                         const RewriteOptions& options);
+
+}  // namespace tools
+}  // namespace parquet
+
+#endif  // PARQUET_TOOLS_FILE_REWRITER_H
@@ -0,0 +1,394 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "page_prefetcher.h"
+
+#include <algorithm>
+#include <sstream>
+
+#include "arrow/buffer.h"
+#include "arrow/util/compression.h"
+
+#include "parquet/column_reader.h"
+#include "parquet/exception.h"
+#include "parquet/thrift.h"
+#include "parquet/util/memory.h"
+
+#include "file_merger.h"
+
+namespace parquet {
+namespace tools {
+
+struct PrefetchingPageReader::PendingPage {
+  format::PageHeader header;
+  std::future<std::shared_ptr<Buffer>> payload;
+};
+
+namespace {
+
+// Smallest size class of DecompressionBufferPool
+constexpr int64_t kMinBufferClass = 4096;
+
+// Upper bound on the page buffers kept by the pool of a PrefetchingPageReader
+// that was not given one
+constexpr int64_t kReaderRetainedPageBytes = 16 * 1024 * 1024;
+
+int64_t BufferClass(int64_t size) {
+  int64_t capacity = kMinBufferClass;
+  while (capacity < size) {
+    capacity <<= 1;
+  }
+  return capacity;
+}
+
+// Codec instances keep stream state, so every task creates its own
+std::shared_ptr<Buffer> DecompressPage(
+    const std::shared_ptr<Buffer>& compressed, Compression::type codec,
+    int64_t uncompressed_size, const std::shared_ptr<DecompressionBufferPool>& buffers) {
+  std::unique_ptr<::arrow::util::Codec> decompressor = GetCodecFromArrow(codec);
+  std::shared_ptr<ResizableBuffer> out = buffers->Acquire(uncompressed_size);
+  PARQUET_THROW_NOT_OK(decompressor->Decompress(compressed->size(), compressed->data(),
+                                                uncompressed_size,
+                                                out->mutable_data()));
+  return out;
+}
+
+EncodedStatistics PageStatistics(const format::Statistics& stats) {
+  EncodedStatistics page_statistics;
+  if (stats.__isset.max) {
+    page_statistics.set_max(stats.max);
+  }
+  if (stats.__isset.min) {
+    page_statistics.set_min(stats.min);
+  }
+  if (stats.__isset.null_count) {
+    page_statistics.set_null_count(stats.null_count);
+  }
+  if (stats.__isset.distinct_count) {
+    page_statistics.set_distinct_count(stats.distinct_count);
+  }
+  return page_statistics;
+}
+
+}  // namespace
+
+DecompressionBufferPool::DecompressionBufferPool(int64_t max_retained_bytes,
+                                                 ::arrow::MemoryPool* memory_pool)
+    : max_retained_bytes_(max_retained_bytes), memory_pool_(memory_pool) {}
+
+std::shared_ptr<ResizableBuffer> DecompressionBufferPool::Acquire(int64_t size) {
+  const int64_t capacity = BufferClass(size);
+  std::shared_ptr<ResizableBuffer> buffer;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.num_requests++;
+    auto it = free_buffers_.find(capacity);
+    if (it != free_buffers_.end() && !it->second.empty()) {
+      buffer = std::move(it->second.back());
+      it->second.pop_back();
+      stats_.num_hits++;
+      stats_.bytes_retained -= capacity;
+    }
+  }
+  if (!buffer) {
+    buffer = AllocateBuffer(memory_pool_, capacity);
+  }
+  // Shrinking the size keeps the capacity, so the buffer stays in its class
+  PARQUET_THROW_NOT_OK(buffer->Resize(size, false));
+
+  // The handle keeps the buffer alive and hands it back on destruction
+  std::shared_ptr<DecompressionBufferPool> self = shared_from_this();
+  return std::shared_ptr<ResizableBuffer>(
+      buffer.get(), [self, buffer](ResizableBuffer*) { self->Release(buffer); });
+}
+
+void DecompressionBufferPool::Release(const std::shared_ptr<ResizableBuffer>& buffer) {
+  const int64_t capacity = BufferClass(buffer->capacity());
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (capacity != buffer->capacity() ||
+      stats_.bytes_retained + capacity > max_retained_bytes_) {
+    return;
+  }
+  free_buffers_[capacity].push_back(buffer);
+  stats_.bytes_retained += capacity;
+  stats_.max_bytes_retained = std::max(stats_.max_bytes_retained, stats_.bytes_retained);
+}
+
+DecompressionBufferPoolStats DecompressionBufferPool::stats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stats_;
+}
+
+PrefetchingPageReader::PrefetchingPageReader(
+    const std::shared_ptr<Buffer>& chunk, const ColumnChunkMetaData& metadata,
+    ::arrow::internal::ThreadPool* pool, int readahead,
+    const std::shared_ptr<DecompressionBufferPool>& buffers,
+    ::arrow::MemoryPool* memory_pool)
+    : chunk_(chunk),
+      codec_(metadata.compression()),
+      pool_(pool),
+      readahead_(std::max(readahead, 1)),
+      buffers_(buffers ? buffers
+                       : std::make_shared<DecompressionBufferPool>(
+                             kReaderRetainedPageBytes, memory_pool)),
+      offset_(0),
+      num_values_(metadata.num_values()),
+      seen_num_values_(0) {
+  while (static_cast<int>(pending_.size()) < readahead_ && SchedulePage()) {
+  }
+}
+
+PrefetchingPageReader::~PrefetchingPageReader() {
+  // Let the in-flight tasks finish before their results are dropped
+  for (const auto& page : pending_) {
+    page->payload.wait();
+  }
+}
+
+bool PrefetchingPageReader::SchedulePage() {
+  while (seen_num_values_ < num_values_ && offset_ < chunk_->size()) {
+    std::unique_ptr<PendingPage> page(new PendingPage());
+    uint32_t header_size = static_cast<uint32_t>(chunk_->size() - offset_);
+    DeserializeThriftMsg(chunk_->data() + offset_, &header_size, &page->header);
+    offset_ += header_size;
+
+    const int64_t compressed_len = page->header.compressed_page_size;
+    const int64_t uncompressed_len = page->header.uncompressed_page_size;
+    if (compressed_len < 0 || offset_ + compressed_len > chunk_->size()) {
+      std::stringstream ss;
+      ss << "Page of " << compressed_len << " bytes at offset " << offset_
+         << " extends past the end of the column chunk";
+      throw ParquetException(ss.str());
+    }
+    std::shared_ptr<Buffer> compressed =
+        ::arrow::SliceBuffer(chunk_, offset_, compressed_len);
+    offset_ += compressed_len;
+
+    const format::PageType::type type = page->header.type;
+    if (type != format::PageType::DICTIONARY_PAGE &&
+        type != format::PageType::DATA_PAGE &&
+        type != format::PageType::DATA_PAGE_V2) {
+      // Same as SerializedPageReader: unknown page types are skipped
+      continue;
+    }
+    if (type == format::PageType::DATA_PAGE) {
+      seen_num_values_ += page->header.data_page_header.num_values;
+    } else if (type == format::PageType::DATA_PAGE_V2) {
+      seen_num_values_ += page->header.data_page_header_v2.num_values;
+    }
+
+    if (codec_ == Compression::UNCOMPRESSED) {
+      std::promise<std::shared_ptr<Buffer>> ready;
+      ready.set_value(compressed);
+      page->payload = ready.get_future();
+    } else {
+      const Compression::type codec = codec_;
+      std::shared_ptr<DecompressionBufferPool> buffers = buffers_;
+      page->payload = pool_->Submit([compressed, codec, uncompressed_len, buffers]() {
+        return DecompressPage(compressed, codec, uncompressed_len, buffers);
+      });
+    }
+    pending_.push_back(std::move(page));
+    return true;
+  }
+  return false;
+}
+
+std::shared_ptr<Page> PrefetchingPageReader::NextPage() {
+  if (pending_.empty()) {
+    return std::shared_ptr<Page>(nullptr);
+  }
+  std::unique_ptr<PendingPage> page = std::move(pending_.front());
+  pending_.pop_front();
+  SchedulePage();
+
+  std::shared_ptr<Buffer> payload = page->payload.get();
+  const format::PageHeader& header = page->header;
+  if (header.type == format::PageType::DICTIONARY_PAGE) {
+    const format::DictionaryPageHeader& dict_header = header.dictionary_page_header;
+    bool is_sorted = dict_header.__isset.is_sorted ? dict_header.is_sorted : false;
+    return std::make_shared<DictionaryPage>(
+        payload, dict_header.num_values,
+        static_cast<Encoding::type>(dict_header.encoding), is_sorted);
+  } else if (header.type == format::PageType::DATA_PAGE) {
+    const format::DataPageHeader& data_header = header.data_page_header;
+    EncodedStatistics page_statistics;
+    if (data_header.__isset.statistics) {
+      page_statistics = PageStatistics(data_header.statistics);
+    }
+    return std::make_shared<DataPage>(
+        payload, data_header.num_values,
+        static_cast<Encoding::type>(data_header.encoding),
+        static_cast<Encoding::type>(data_header.definition_level_encoding),
+        static_cast<Encoding::type>(data_header.repetition_level_encoding),
+        page_statistics);
+  } else {
+    const format::DataPageHeaderV2& data_header = header.data_page_header_v2;
+    bool is_compressed =
+        data_header.__isset.is_compressed ? data_header.is_compressed : false;
+    return std::make_shared<DataPageV2>(
+        payload, data_header.num_values, data_header.num_nulls, data_header.num_rows,
+        static_cast<Encoding::type>(data_header.encoding),
+        data_header.definition_levels_byte_length,
+        data_header.repetition_levels_byte_length, is_compressed);
+  }
+}
+
+RowGroupPrebuffer::RowGroupPrebuffer(::arrow::io::RandomAccessFile* file,
+                                     const RowGroupMetaData& row_group,
+                                     const std::vector<int>& columns,
+                                     ::arrow::internal::ThreadPool* pool,
+                                     int64_t hole_size_limit, int64_t range_size_limit) {
+  struct ChunkRange {
+    int column;
+    int64_t start;
+    int64_t length;
+  };
+  std::vector<ChunkRange> ranges;
+  for (int column : columns) {
+    std::unique_ptr<ColumnChunkMetaData> metadata = row_group.ColumnChunk(column);
+    ranges.push_back({column, ColumnChunkStart(*metadata),
+                      metadata->total_compressed_size()});
+  }
+  std::sort(ranges.begin(), ranges.end(), [](const ChunkRange& a, const ChunkRange& b) {
+    return a.start < b.start;
+  });
+
+  // Group the chunks into reads; a chunk is never split across two reads
+  auto submit = [this, file, pool](int64_t start, int64_t end) {
+    std::future<std::shared_ptr<Buffer>> read = pool->Submit(
+        [file, start, end]() { return ReadRange(file, start, end - start); });
+    reads_.push_back(read.share());
+  };
+  int64_t read_start = 0;
+  int64_t read_end = 0;
+  for (const ChunkRange& range : ranges) {
+    const int64_t end = range.start + range.length;
+    const bool extend = !slices_.empty() && range.start - read_end <= hole_size_limit &&
+                        std::max(end, read_end) - read_start <= range_size_limit;
+    if (!extend) {
+      if (!slices_.empty()) {
+        submit(read_start, read_end);
+      }
+      read_start = range.start;
+      read_end = end;
+    }
+    read_end = std::max(read_end, end);
+    slices_[range.column] = {static_cast<int>(reads_.size()), range.start - read_start,
+                             range.length};
+  }
+  if (!slices_.empty()) {
+    submit(read_start, read_end);
+  }
+}
+
+RowGroupPrebuffer::~RowGroupPrebuffer() {
+  // The reads refer to the file, which may be closed once this returns
+  for (const auto& read : reads_) {
+    read.wait();
+  }
+}
+
+std::shared_ptr<Buffer> RowGroupPrebuffer::ColumnChunk(int column) {
+  auto it = slices_.find(column);
+  if (it == slices_.end()) {
+    std::stringstream ss;
+    ss << "Column " << column << " was not pre-buffered";
+    throw ParquetException(ss.str());
+  }
+  const ChunkSlice& slice = it->second;
+  return ::arrow::SliceBuffer(reads_[slice.read].get(), slice.offset, slice.length);
+}
+
+int64_t ScanFileContentsPrefetched(
+    std::vector<int> columns, const int32_t batch_size,
+    ::arrow::io::RandomAccessFile* file, const std::shared_ptr<FileMetaData>& footer,
+    int num_threads, int readahead,
+    const std::shared_ptr<DecompressionBufferPool>& buffers) {
+  CheckColumnChunkSizes(*footer);
+
+  // Reads get a pool of their own: on the decompression pool, the reads of
+  // the next row group would queue ahead of the current one's pages
+  std::shared_ptr<::arrow::internal::ThreadPool> pool;
+  PARQUET_THROW_NOT_OK(
+      ::arrow::internal::ThreadPool::Make(std::max(num_threads, 1), &pool));
+  std::shared_ptr<::arrow::internal::ThreadPool> io_pool;
+  PARQUET_THROW_NOT_OK(
+      ::arrow::internal::ThreadPool::Make(std::max(num_threads, 1), &io_pool));
+
+  std::vector<int16_t> rep_levels(batch_size);
+  std::vector<int16_t> def_levels(batch_size);
+  int num_columns = static_cast<int>(columns.size());
+
+  // columns are not specified explicitly. Add all columns
+  if (columns.size() == 0) {
+    num_columns = footer->num_columns();
+    columns.resize(num_columns);
+    for (int i = 0; i < num_columns; i++) {
+      columns[i] = i;
+    }
+  }
+
+  std::vector<int64_t> total_rows(num_columns, 0);
+
+  auto prebuffer = [&](int r) {
+    return std::unique_ptr<RowGroupPrebuffer>(
+        new RowGroupPrebuffer(file, *footer->RowGroup(r), columns, io_pool.get()));
+  };
+  std::unique_ptr<RowGroupPrebuffer> next;
+  if (footer->num_row_groups() > 0) {
+    next = prebuffer(0);
+  }
+
+  for (int r = 0; r < footer->num_row_groups(); ++r) {
+    std::unique_ptr<RowGroupMetaData> row_group = footer->RowGroup(r);
+    std::unique_ptr<RowGroupPrebuffer> chunks = std::move(next);
+    if (r + 1 < footer->num_row_groups()) {
+      next = prebuffer(r + 1);
+    }
+    int col = 0;
+    for (auto i : columns) {
+      std::unique_ptr<ColumnChunkMetaData> metadata = row_group->ColumnChunk(i);
+      std::unique_ptr<PageReader> pages(new PrefetchingPageReader(
+          chunks->ColumnChunk(i), *metadata, pool.get(), readahead, buffers));
+      const ColumnDescriptor* descr = footer->schema()->Column(i);
+      std::shared_ptr<ColumnReader> col_reader =
+          ColumnReader::Make(descr, std::move(pages));
+      size_t value_byte_size = GetTypeByteSize(descr->physical_type());
+      std::vector<uint8_t> values(batch_size * value_byte_size);
+
+      int64_t values_read = 0;
+      while (col_reader->HasNext()) {
+        total_rows[col] +=
+            ScanAllValues(batch_size, def_levels.data(), rep_levels.data(),
+                          values.data(), &values_read, col_reader.get());
+      }
+      col++;
+    }
+  }
+
+  for (int i = 1; i < num_columns; ++i) {
+    if (total_rows[0] != total_rows[i]) {
+      throw ParquetException("Parquet error: Total rows among columns do not match");
+    }
+  }
+
+  return total_rows[0];
+}
+
+}  // namespace tools
+}  // namespace parquet
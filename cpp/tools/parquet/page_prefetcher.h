@@ -0,0 +1,164 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#ifndef PARQUET_TOOLS_PAGE_PREFETCHER_H
+#define PARQUET_TOOLS_PAGE_PREFETCHER_H
+
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "arrow/util/thread-pool.h"
+
+#include "parquet/api/reader.h"
+
+namespace parquet {
+namespace tools {
+
+struct DecompressionBufferPoolStats {
+  // Buffers handed out, and how many of them were recycled
+  int64_t num_requests = 0;
+  int64_t num_hits = 0;
+  // Capacity of the buffers currently held for reuse
+  int64_t bytes_retained = 0;
+  int64_t max_bytes_retained = 0;
+};
+
+// A thread-safe pool of decompression output buffers, bucketed by
+// power-of-two capacity. A buffer returned by Acquire goes back to the pool
+// when its last reference is dropped, so page buffers are recycled across
+// pages, column chunks and row groups instead of being allocated per page.
+// Released buffers are freed once `max_retained_bytes` are held.
+class DecompressionBufferPool
+    : public std::enable_shared_from_this<DecompressionBufferPool> {
+ public:
+  explicit DecompressionBufferPool(
+      int64_t max_retained_bytes,
+      ::arrow::MemoryPool* memory_pool = ::arrow::default_memory_pool());
+
+  // Returns a buffer of `size` bytes
+  std::shared_ptr<ResizableBuffer> Acquire(int64_t size);
+
+  DecompressionBufferPoolStats stats() const;
+
+ private:
+  void Release(const std::shared_ptr<ResizableBuffer>& buffer);
+
+  int64_t max_retained_bytes_;
+  ::arrow::MemoryPool* memory_pool_;
+
+  mutable std::mutex mutex_;
+  std::map<int64_t, std::vector<std::shared_ptr<ResizableBuffer>>> free_buffers_;
+  DecompressionBufferPoolStats stats_;
+};
+
+// A PageReader over a column chunk held in memory that decompresses the
+// upcoming pages on a thread pool while the consumer decodes the current one.
+//
+// Page headers are parsed on the calling thread as pages are scheduled; up to
+// `readahead` page payloads are being decompressed at any time. Pages are
+// returned in file order, so the reader can be passed to ColumnReader::Make
+// in place of the serialized page reader. Decompressed page buffers come from
+// `buffers` when given, and otherwise from a pool of the reader's own that
+// allocates from `memory_pool`, so they are recycled from page to page either
+// way; pages of uncompressed chunks are slices of `chunk` and are not copied.
+class PrefetchingPageReader : public PageReader {
+ public:
+  PrefetchingPageReader(const std::shared_ptr<Buffer>& chunk,
+                        const ColumnChunkMetaData& metadata,
+                        ::arrow::internal::ThreadPool* pool, int readahead,
+                        const std::shared_ptr<DecompressionBufferPool>& buffers = nullptr,
+                        ::arrow::MemoryPool* memory_pool =
+                            ::arrow::default_memory_pool());
+
+  ~PrefetchingPageReader() override;
+
+  std::shared_ptr<Page> NextPage() override;
+
+ private:
+  struct PendingPage;
+
+  // Parses the next page header and submits its payload for decompression.
+  // Returns false once the column chunk is exhausted.
+  bool SchedulePage();
+
+  std::shared_ptr<Buffer> chunk_;
+  Compression::type codec_;
+  ::arrow::internal::ThreadPool* pool_;
+  int readahead_;
+  std::shared_ptr<DecompressionBufferPool> buffers_;
+
+  int64_t offset_;
+  int64_t num_values_;
+  int64_t seen_num_values_;
+  std::deque<std::unique_ptr<PendingPage>> pending_;
+};
+
+constexpr int64_t kDefaultHoleSizeLimit = 1024 * 1024;
+constexpr int64_t kDefaultRangeSizeLimit = 32 * 1024 * 1024;
+
+// The column chunks of a row group that a scan needs, fetched ahead of time
+// with as few reads as possible. Chunks at most `hole_size_limit` bytes apart
+// are read together, up to `range_size_limit` bytes per read, and all reads
+// are issued concurrently on `pool`.
+class RowGroupPrebuffer {
+ public:
+  RowGroupPrebuffer(::arrow::io::RandomAccessFile* file,
+                    const RowGroupMetaData& row_group, const std::vector<int>& columns,
+                    ::arrow::internal::ThreadPool* pool,
+                    int64_t hole_size_limit = kDefaultHoleSizeLimit,
+                    int64_t range_size_limit = kDefaultRangeSizeLimit);
+
+  ~RowGroupPrebuffer();
+
+  // Waits for the read covering `column` and returns the bytes of its chunk
+  std::shared_ptr<Buffer> ColumnChunk(int column);
+
+  int num_reads() const { return static_cast<int>(reads_.size()); }
+
+ private:
+  struct ChunkSlice {
+    int read;
+    int64_t offset;
+    int64_t length;
+  };
+
+  std::vector<std::shared_future<std::shared_ptr<Buffer>>> reads_;
+  std::map<int, ChunkSlice> slices_;
+};
+
+// Reads every value of `columns` (all columns if empty) like
+// parquet::ScanFileContents, but through PrefetchingPageReaders sharing a pool
+// of `num_threads` threads and the page buffers of `buffers`; if it is null,
+// every reader recycles page buffers on its own.
+// The projected column chunks of the next row group are pre-buffered on a
+// separate pool of `num_threads` threads while the current one is scanned.
+// Returns the number of rows scanned.
+int64_t ScanFileContentsPrefetched(
+    std::vector<int> columns, const int32_t batch_size,
+    ::arrow::io::RandomAccessFile* file, const std::shared_ptr<FileMetaData>& footer,
+    int num_threads, int readahead,
+    const std::shared_ptr<DecompressionBufferPool>& buffers = nullptr);
+
+}  // namespace tools
+}  // namespace parquet
+
+#endif  // PARQUET_TOOLS_PAGE_PREFETCHER_H
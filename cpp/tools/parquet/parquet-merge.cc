@@ -0,0 +1,105 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "arrow/io/file.h"
+
+#include "parquet/exception.h"
+
+#include "file_merger.h"
+
+int main(int argc, char** argv) {
+  if (argc < 3) {
+    std::cerr << "Usage: parquet-merge [--threads=N] [--group-size=BYTES] "
+                 "[--coalesce=BYTES] [--row-group-size=BYTES] [--sort-by=...] "
+                 "<output> <input>..."
+              << std::endl;
+    return -1;
+  }
+
+  std::string output;
+  std::vector<std::string> inputs;
+
+  // Read command-line options
+  parquet::tools::MergeOptions options;
+  options.num_threads =
+      std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+  const std::string THREADS_PREFIX = "--threads=";
+  const std::string GROUP_SIZE_PREFIX = "--group-size=";
+  const std::string COALESCE_PREFIX = "--coalesce=";
+  const std::string ROW_GROUP_SIZE_PREFIX = "--row-group-size=";
+  const std::string SORT_BY_PREFIX = "--sort-by=";
+
+  char *param, *value;
+  for (int i = 1; i < argc; i++) {
+    if ((param = std::strstr(argv[i], THREADS_PREFIX.c_str()))) {
+      options.num_threads = std::atoi(param + THREADS_PREFIX.length());
+    } else if ((param = std::strstr(argv[i], GROUP_SIZE_PREFIX.c_str()))) {
+      options.group_size = std::atoll(param + GROUP_SIZE_PREFIX.length());
+    } else if ((param = std::strstr(argv[i], COALESCE_PREFIX.c_str()))) {
+      options.coalesce_threshold = std::atoll(param + COALESCE_PREFIX.length());
+    } else if ((param = std::strstr(argv[i], ROW_GROUP_SIZE_PREFIX.c_str()))) {
+      options.row_group_size = std::atoll(param + ROW_GROUP_SIZE_PREFIX.length());
+    } else if ((param = std::strstr(argv[i], SORT_BY_PREFIX.c_str()))) {
+      value = std::strtok(param + SORT_BY_PREFIX.length(), ",");
+      while (value) {
+        options.sort_columns.push_back(std::atoi(value));
+        value = std::strtok(nullptr, ",");
+      }
+    } else if (output.empty()) {
+      output = argv[i];
+    } else {
+      inputs.push_back(argv[i]);
+    }
+  }
+
+  try {
+    auto start_time = std::chrono::steady_clock::now();
+    std::shared_ptr<::arrow::io::FileOutputStream> out_file;
+    PARQUET_THROW_NOT_OK(::arrow::io::FileOutputStream::Open(output, &out_file));
+
+    // Sorted inputs are merged row by row, everything else by row group
+    parquet::tools::MergeStats stats =
+        options.sort_columns.empty()
+            ? parquet::tools::MergeFiles(inputs, out_file, options)
+            : parquet::tools::MergeSortedFiles(inputs, out_file, options);
+
+    std::chrono::duration<double> total_time =
+        std::chrono::steady_clock::now() - start_time;
+    std::cout << "Merged " << inputs.size() << " files (" << stats.num_input_row_groups
+              << " row groups) into " << stats.num_output_row_groups << " row groups, "
+              << stats.num_rows << " rows in " << total_time.count() << " seconds."
+              << std::endl;
+    std::cout << stats.bytes_copied << " bytes copied, " << stats.bytes_reencoded
+              << " bytes re-encoded from " << stats.num_reencoded_row_groups
+              << " small row groups." << std::endl;
+  } catch (const std::exception& e) {
+    std::cerr << "Parquet error: " << e.what() << std::endl;
+    return -1;
+  }
+
+  return 0;
+}
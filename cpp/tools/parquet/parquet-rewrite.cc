@@ -0,0 +1,136 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "arrow/io/file.h"
+
+#include "parquet/exception.h"
+
+#include "file_merger.h"
+#include "file_rewriter.h"
+
+static parquet::Compression::type ParseCodec(const std::string& name) {
+  static const std::pair<const char*, parquet::Compression::type> codecs[] = {
+      {"UNCOMPRESSED", parquet::Compression::UNCOMPRESSED},
+      {"SNAPPY", parquet::Compression::SNAPPY},
+      {"GZIP", parquet::Compression::GZIP},
+      {"LZO", parquet::Compression::LZO},
+      {"BROTLI", parquet::Compression::BROTLI},
+      {"LZ4", parquet::Compression::LZ4},
+      {"ZSTD", parquet::Compression::ZSTD}};
+  for (const auto& codec : codecs) {
+    if (name == codec.first) {
+      return codec.second;
+    }
+  }
+  throw parquet::ParquetException("Unknown compression codec: " + name);
+}
+
+static parquet::Encoding::type ParseEncoding(const std::string& name) {
+  static const std::pair<const char*, parquet::Encoding::type> encodings[] = {
+      {"PLAIN", parquet::Encoding::PLAIN},
+      {"DICTIONARY", parquet::Encoding::PLAIN_DICTIONARY}};
+  for (const auto& encoding : encodings) {
+    if (name == encoding.first) {
+      return encoding.second;
+    }
+  }
+  throw parquet::ParquetException("Unsupported encoding: " + name +
+                                  ", expected PLAIN or DICTIONARY");
+}
+
+int main(int argc, char** argv) {
+  if (argc < 3) {
+    std::cerr << "Usage: parquet-rewrite [--threads=N] [--codec=[<column>:]CODEC]... "
+                 "[--encoding=<column>:ENCODING]... <input> <output>"
+              << std::endl;
+    return -1;
+  }
+
+  std::string input;
+  std::string output;
+
+  try {
+    // Read command-line options
+    parquet::tools::RewriteOptions options;
+    options.num_threads =
+        std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    const std::string THREADS_PREFIX = "--threads=";
+    const std::string CODEC_PREFIX = "--codec=";
+    const std::string ENCODING_PREFIX = "--encoding=";
+
+    char *param, *value;
+    for (int i = 1; i < argc; i++) {
+      if ((param = std::strstr(argv[i], THREADS_PREFIX.c_str()))) {
+        options.num_threads = std::atoi(param + THREADS_PREFIX.length());
+      } else if ((param = std::strstr(argv[i], CODEC_PREFIX.c_str()))) {
+        value = param + CODEC_PREFIX.length();
+        if (char* name = std::strchr(value, ':')) {
+          options.column_codecs[std::atoi(value)] = ParseCodec(name + 1);
+        } else {
+          options.set_codec = true;
+          options.codec = ParseCodec(value);
+        }
+      } else if ((param = std::strstr(argv[i], ENCODING_PREFIX.c_str()))) {
+        value = param + ENCODING_PREFIX.length();
+        char* name = std::strchr(value, ':');
+        if (name == nullptr) {
+          throw parquet::ParquetException("--encoding expects <column>:ENCODING");
+        }
+        options.column_encodings[std::atoi(value)] = ParseEncoding(name + 1);
+      } else if (input.empty()) {
+        input = argv[i];
+      } else {
+        output = argv[i];
+      }
+    }
+
+    // Fail before the output file is created or truncated
+    parquet::tools::CheckRewriteOptions(
+        *parquet::tools::ReadFileFooter(input)->schema(), options);
+
+    auto start_time = std::chrono::steady_clock::now();
+    std::shared_ptr<::arrow::io::FileOutputStream> out_file;
+    PARQUET_THROW_NOT_OK(::arrow::io::FileOutputStream::Open(output, &out_file));
+
+    parquet::tools::RewriteStats stats =
+        parquet::tools::RewriteFile(input, out_file, options);
+
+    std::chrono::duration<double> total_time =
+        std::chrono::steady_clock::now() - start_time;
+    std::cout << "Rewrote " << stats.num_column_chunks << " column chunks ("
+              << stats.num_recompressed_chunks << " recompressed, "
+              << stats.num_reencoded_chunks << " re-encoded, "
+              << stats.num_copied_chunks << " copied) in " << total_time.count()
+              << " seconds." << std::endl;
+    std::cout << stats.bytes_read << " bytes of column chunks read, "
+              << stats.bytes_written << " bytes written." << std::endl;
+  } catch (const std::exception& e) {
+    std::cerr << "Parquet error: " << e.what() << std::endl;
+    return -1;
+  }
+
+  return 0;
+}
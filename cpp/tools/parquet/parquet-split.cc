@@ -0,0 +1,184 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "arrow/io/file.h"
+
+#include "parquet/exception.h"
+#include "parquet/file_writer.h"
+#include "parquet/metadata.h"
+#include "parquet/util/memory.h"
+
+#include "file_merger.h"
+
+// Returns the size of a footer (plus length and magic) that RawFileWriter
+// writes for `prototype` before any row group is appended
+static int64_t EmptyFooterSize(const parquet::FileMetaData& prototype) {
+  std::unique_ptr<parquet::FileMetaDataBuilder> builder =
+      parquet::FileMetaDataBuilder::Make(prototype.schema(),
+                                         parquet::tools::PrototypeProperties(prototype),
+                                         prototype.key_value_metadata());
+  parquet::InMemoryOutputStream sink;
+  parquet::WriteFileMetaData(*builder->Finish(), &sink);
+  return sink.Tell();
+}
+
+static std::string OutputPath(const std::string& prefix, int index) {
+  char suffix[32];
+  std::snprintf(suffix, sizeof(suffix), "-%05d.parquet", index);
+  return prefix + suffix;
+}
+
+int main(int argc, char** argv) {
+  if (argc < 4) {
+    std::cerr << "Usage: parquet-split --max-size=BYTES <input> <output-prefix>"
+              << std::endl;
+    return -1;
+  }
+
+  std::string input;
+  std::string prefix;
+
+  // Read command-line options
+  int64_t max_size = 0;
+  const std::string MAX_SIZE_PREFIX = "--max-size=";
+
+  char* param;
+  for (int i = 1; i < argc; i++) {
+    if ((param = std::strstr(argv[i], MAX_SIZE_PREFIX.c_str()))) {
+      max_size = std::atoll(param + MAX_SIZE_PREFIX.length());
+    } else if (input.empty()) {
+      input = argv[i];
+    } else {
+      prefix = argv[i];
+    }
+  }
+
+  try {
+    if (max_size <= 0) {
+      throw parquet::ParquetException("--max-size must be positive");
+    }
+    auto start_time = std::chrono::steady_clock::now();
+
+    std::shared_ptr<::arrow::io::ReadableFile> in_file;
+    PARQUET_THROW_NOT_OK(::arrow::io::ReadableFile::Open(input, &in_file));
+    std::shared_ptr<parquet::FileMetaData> footer = parquet::ReadMetaData(in_file);
+
+    // An output footer is the schema part the writer produces, which is
+    // measured, plus the metadata of its row groups. The writer may serialize
+    // column statistics twice (deprecated min/max next to min_value/max_value),
+    // so twice the average size a row group takes up in the input footer is
+    // reserved for each. Files are still checked after they are closed.
+    const int64_t base_footer_size = EmptyFooterSize(*footer);
+    int64_t row_group_footer_size = 0;
+    if (footer->num_row_groups() > 0) {
+      const int64_t input_row_groups_size =
+          std::max<int64_t>(0, footer->size() + 8 - base_footer_size);
+      row_group_footer_size =
+          2 * ((input_row_groups_size + footer->num_row_groups() - 1) /
+               footer->num_row_groups());
+    }
+    auto estimated_size = [&](int64_t data_bytes, int num_row_groups) {
+      return 4 + data_bytes + base_footer_size + num_row_groups * row_group_footer_size;
+    };
+
+    // The next row group is read while the current one is written
+    auto read_row_group = [&](int row_group) {
+      return std::async(std::launch::async, [in_file, footer, row_group]() {
+        return parquet::tools::ReadRawRowGroup(in_file.get(), footer, row_group);
+      });
+    };
+
+    std::unique_ptr<parquet::tools::RawFileWriter> writer;
+    int num_files = 0;
+    int num_oversized = 0;
+    std::vector<std::string> oversized_files;
+    // Closes the current output file and records it if the limit was missed
+    auto close_writer = [&]() {
+      if (writer->Close() > max_size) {
+        oversized_files.push_back(OutputPath(prefix, num_files - 1));
+      }
+      writer.reset();
+    };
+    int64_t bytes_buffered = 0;
+    std::future<std::shared_ptr<parquet::tools::RawRowGroup>> next;
+    if (footer->num_row_groups() > 0) {
+      next = read_row_group(0);
+    }
+    for (int r = 0; r < footer->num_row_groups(); ++r) {
+      std::shared_ptr<parquet::tools::RawRowGroup> row_group = next.get();
+      if (r + 1 < footer->num_row_groups()) {
+        next = read_row_group(r + 1);
+      }
+
+      int64_t row_group_bytes = 0;
+      for (const auto& chunk : row_group->chunks) {
+        row_group_bytes += chunk->size();
+      }
+      if (writer && estimated_size(bytes_buffered + row_group_bytes,
+                                   writer->num_row_groups() + 1) > max_size) {
+        close_writer();
+      }
+      if (!writer) {
+        std::shared_ptr<::arrow::io::FileOutputStream> out_file;
+        PARQUET_THROW_NOT_OK(::arrow::io::FileOutputStream::Open(
+            OutputPath(prefix, num_files++), &out_file));
+        writer.reset(new parquet::tools::RawFileWriter(out_file, footer));
+        bytes_buffered = 0;
+      }
+      // Row groups cannot be split without decoding, so a row group larger
+      // than the limit gets a file of its own
+      if (estimated_size(row_group_bytes, 1) > max_size) {
+        num_oversized++;
+      }
+      writer->AppendRowGroup({row_group});
+      bytes_buffered += row_group_bytes;
+    }
+    if (writer) {
+      close_writer();
+    }
+    PARQUET_THROW_NOT_OK(in_file->Close());
+
+    std::chrono::duration<double> total_time =
+        std::chrono::steady_clock::now() - start_time;
+    std::cout << "Split " << footer->num_row_groups() << " row groups into "
+              << num_files << " files in " << total_time.count() << " seconds."
+              << std::endl;
+    if (num_oversized > 0) {
+      std::cerr << num_oversized << " row groups exceed --max-size on their own"
+                << std::endl;
+    }
+    for (const auto& path : oversized_files) {
+      std::cerr << path << " exceeds --max-size" << std::endl;
+    }
+  } catch (const std::exception& e) {
+    std::cerr << "Parquet error: " << e.what() << std::endl;
+    return -1;
+  }
+
+  return 0;
+}
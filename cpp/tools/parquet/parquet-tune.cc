@@ -0,0 +1,249 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <future>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "arrow/buffer.h"
+#include "arrow/util/compression.h"
+#include "arrow/util/thread-pool.h"
+
+#include "parquet/api/reader.h"
+#include "parquet/util/memory.h"
+
+// Codecs tried for every column; the ones this build lacks are skipped
+static const std::pair<const char*, parquet::Compression::type> kCodecs[] = {
+    {"UNCOMPRESSED", parquet::Compression::UNCOMPRESSED},
+    {"SNAPPY", parquet::Compression::SNAPPY},
+    {"GZIP", parquet::Compression::GZIP},
+    {"LZO", parquet::Compression::LZO},
+    {"BROTLI", parquet::Compression::BROTLI},
+    {"LZ4", parquet::Compression::LZ4},
+    {"ZSTD", parquet::Compression::ZSTD}};
+
+// Decompression is timed this many times and the fastest run is kept
+static constexpr int kTimingRuns = 3;
+
+using PageList = std::vector<std::shared_ptr<parquet::Buffer>>;
+
+struct CodecResult {
+  bool available = false;
+  int64_t compressed_bytes = 0;
+  double decompress_seconds = 0;
+};
+
+// Returns the uncompressed payloads of all pages of `column`, dictionary
+// pages included
+static std::shared_ptr<PageList> ReadColumnPages(parquet::ParquetFileReader* reader,
+                                                 int column) {
+  auto pages = std::make_shared<PageList>();
+  for (int r = 0; r < reader->metadata()->num_row_groups(); ++r) {
+    std::unique_ptr<parquet::PageReader> page_reader =
+        reader->RowGroup(r)->GetColumnPageReader(column);
+    while (std::shared_ptr<parquet::Page> page = page_reader->NextPage()) {
+      // The page buffer is reused for the next page
+      std::shared_ptr<parquet::ResizableBuffer> copy =
+          parquet::AllocateBuffer(::arrow::default_memory_pool(), page->size());
+      std::memcpy(copy->mutable_data(), page->data(), page->size());
+      pages->push_back(copy);
+    }
+  }
+  return pages;
+}
+
+// Compresses every page on its own, as the column writer does, and times
+// decompressing them again
+static CodecResult EvaluateCodec(const std::shared_ptr<PageList>& pages,
+                                 parquet::Compression::type type) {
+  CodecResult result;
+  std::unique_ptr<::arrow::util::Codec> codec;
+  try {
+    codec = parquet::GetCodecFromArrow(type);
+  } catch (const parquet::ParquetException&) {
+    return result;
+  }
+  result.available = true;
+  if (codec == nullptr) {
+    for (const auto& page : *pages) {
+      result.compressed_bytes += page->size();
+    }
+    return result;
+  }
+
+  std::vector<std::shared_ptr<parquet::ResizableBuffer>> compressed;
+  for (const auto& page : *pages) {
+    int64_t max_compressed_size = codec->MaxCompressedLen(page->size(), page->data());
+    std::shared_ptr<parquet::ResizableBuffer> out =
+        parquet::AllocateBuffer(::arrow::default_memory_pool(), max_compressed_size);
+    int64_t compressed_size;
+    PARQUET_THROW_NOT_OK(codec->Compress(page->size(), page->data(), max_compressed_size,
+                                         out->mutable_data(), &compressed_size));
+    PARQUET_THROW_NOT_OK(out->Resize(compressed_size, false));
+    result.compressed_bytes += compressed_size;
+    compressed.push_back(out);
+  }
+
+  std::shared_ptr<parquet::ResizableBuffer> scratch =
+      parquet::AllocateBuffer(::arrow::default_memory_pool(), 0);
+  for (int run = 0; run < kTimingRuns; ++run) {
+    auto start_time = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < pages->size(); ++i) {
+      const int64_t uncompressed_size = (*pages)[i]->size();
+      PARQUET_THROW_NOT_OK(scratch->Resize(uncompressed_size, false));
+      PARQUET_THROW_NOT_OK(codec->Decompress(compressed[i]->size(),
+                                             compressed[i]->data(), uncompressed_size,
+                                             scratch->mutable_data()));
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start_time;
+    if (run == 0 || elapsed.count() < result.decompress_seconds) {
+      result.decompress_seconds = elapsed.count();
+    }
+  }
+  return result;
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    std::cerr << "Usage: parquet-tune [--threads=N] [--speed-weight=W] <file>"
+              << std::endl;
+    return -1;
+  }
+
+  std::string filename;
+
+  // Read command-line options
+  int num_threads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+  // 0 ranks codecs by compressed size only, 1 by decompression time only
+  double speed_weight = 0.5;
+  const std::string THREADS_PREFIX = "--threads=";
+  const std::string SPEED_WEIGHT_PREFIX = "--speed-weight=";
+
+  char* param;
+  for (int i = 1; i < argc; i++) {
+    if ((param = std::strstr(argv[i], THREADS_PREFIX.c_str()))) {
+      num_threads = std::atoi(param + THREADS_PREFIX.length());
+    } else if ((param = std::strstr(argv[i], SPEED_WEIGHT_PREFIX.c_str()))) {
+      speed_weight = std::atof(param + SPEED_WEIGHT_PREFIX.length());
+    } else {
+      filename = argv[i];
+    }
+  }
+
+  try {
+    if (speed_weight < 0 || speed_weight > 1) {
+      throw parquet::ParquetException("--speed-weight must be between 0 and 1");
+    }
+    std::unique_ptr<parquet::ParquetFileReader> reader =
+        parquet::ParquetFileReader::OpenFile(filename);
+    const parquet::SchemaDescriptor* schema = reader->metadata()->schema();
+    const int num_columns = schema->num_columns();
+    const int num_codecs = static_cast<int>(sizeof(kCodecs) / sizeof(kCodecs[0]));
+
+    std::shared_ptr<::arrow::internal::ThreadPool> pool;
+    PARQUET_THROW_NOT_OK(
+        ::arrow::internal::ThreadPool::Make(std::max(num_threads, 1), &pool));
+
+    // Columns are evaluated one at a time, with one task per codec, so only
+    // the pages of a single column are held in memory
+    std::vector<std::string> recommendations;
+    for (int i = 0; i < num_columns; ++i) {
+      const std::string path = schema->Column(i)->path()->ToDotString();
+      std::shared_ptr<PageList> pages = ReadColumnPages(reader.get(), i);
+      int64_t uncompressed_bytes = 0;
+      for (const auto& page : *pages) {
+        uncompressed_bytes += page->size();
+      }
+      std::vector<std::future<CodecResult>> futures;
+      for (int c = 0; c < num_codecs; ++c) {
+        futures.push_back(pool->Submit(EvaluateCodec, pages, kCodecs[c].second));
+      }
+      pages.reset();
+      std::vector<CodecResult> results;
+      for (auto& future : futures) {
+        results.push_back(future.get());
+      }
+
+      double slowest = 0;
+      for (const auto& result : results) {
+        slowest = std::max(slowest, result.decompress_seconds);
+      }
+
+      // Lower is better: compression ratio and decompression time relative
+      // to the slowest codec, mixed by --speed-weight
+      std::cout << "Column " << i << " (" << path << "), " << uncompressed_bytes
+                << " bytes uncompressed" << std::endl;
+      int best = -1;
+      double best_score = 0;
+      for (int c = 0; c < num_codecs; ++c) {
+        const CodecResult& result = results[c];
+        if (!result.available) {
+          continue;
+        }
+        double size_cost = uncompressed_bytes > 0
+                               ? static_cast<double>(result.compressed_bytes) /
+                                     static_cast<double>(uncompressed_bytes)
+                               : 1.0;
+        double speed_cost = slowest > 0 ? result.decompress_seconds / slowest : 0.0;
+        double score = (1 - speed_weight) * size_cost + speed_weight * speed_cost;
+        double throughput = result.decompress_seconds > 0
+                                ? uncompressed_bytes / result.decompress_seconds / 1e6
+                                : 0.0;
+        std::stringstream line;
+        line << "  " << std::left << std::setw(14) << kCodecs[c].first << std::right
+             << std::setw(14) << result.compressed_bytes << " bytes, ratio "
+             << std::fixed << std::setprecision(3) << size_cost << ", ";
+        if (throughput > 0) {
+          line << std::setprecision(1) << throughput << " MB/s";
+        } else {
+          line << "no decompression";
+        }
+        std::cout << line.str() << std::endl;
+        if (best < 0 || score < best_score) {
+          best = c;
+          best_score = score;
+        }
+      }
+      if (best >= 0) {
+        recommendations.push_back("builder.compression(\"" + path +
+                                  "\", parquet::Compression::" + kCodecs[best].first +
+                                  ");");
+      }
+    }
+
+    std::cout << std::endl
+              << "// Recommended with --speed-weight=" << speed_weight << std::endl
+              << "parquet::WriterProperties::Builder builder;" << std::endl;
+    for (const auto& line : recommendations) {
+      std::cout << line << std::endl;
+    }
+  } catch (const std::exception& e) {
+    std::cerr << "Parquet error: " << e.what() << std::endl;
+    return -1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,612 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "file_merger.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <sstream>
+
+#include "parquet/exception.h"
+#include "parquet/file_reader.h"
+#include "parquet/file_writer.h"
+
+namespace parquet {
+namespace tools {
+
+namespace {
+
+// Values are read from every input and buffered for the writer in batches of
+// this many rows, which bounds the memory held per input and column
+constexpr int64_t kSortedMergeBatchSize = 1024;
+
+// ----------------------------------------------------------------------
+// Value comparison and storage per physical type
+
+template <typename T>
+int CompareValues(const T& a, const T& b, const ColumnDescriptor*) {
+  return a < b ? -1 : (b < a ? 1 : 0);
+}
+
+int CompareValues(const int32_t& a, const int32_t& b, const ColumnDescriptor* descr) {
+  if (descr->sort_order() == SortOrder::UNSIGNED) {
+    return CompareValues(static_cast<uint32_t>(a), static_cast<uint32_t>(b), descr);
+  }
+  return a < b ? -1 : (b < a ? 1 : 0);
+}
+
+int CompareValues(const int64_t& a, const int64_t& b, const ColumnDescriptor* descr) {
+  if (descr->sort_order() == SortOrder::UNSIGNED) {
+    return CompareValues(static_cast<uint64_t>(a), static_cast<uint64_t>(b), descr);
+  }
+  return a < b ? -1 : (b < a ? 1 : 0);
+}
+
+// NaNs sort after all numbers and compare equal to each other, which keeps
+// the order a strict weak ordering
+template <typename T>
+int CompareFloatingPoint(T a, T b) {
+  const bool a_nan = std::isnan(a);
+  const bool b_nan = std::isnan(b);
+  if (a_nan || b_nan) {
+    return static_cast<int>(a_nan) - static_cast<int>(b_nan);
+  }
+  return a < b ? -1 : (b < a ? 1 : 0);
+}
+
+int CompareValues(const float& a, const float& b, const ColumnDescriptor*) {
+  return CompareFloatingPoint(a, b);
+}
+
+int CompareValues(const double& a, const double& b, const ColumnDescriptor*) {
+  return CompareFloatingPoint(a, b);
+}
+
+int CompareUnsignedBytes(const uint8_t* a, uint32_t a_len, const uint8_t* b,
+                         uint32_t b_len) {
+  int cmp = std::memcmp(a, b, std::min(a_len, b_len));
+  if (cmp != 0) {
+    return cmp;
+  }
+  return a_len < b_len ? -1 : (b_len < a_len ? 1 : 0);
+}
+
+// Compares big-endian two's complement integers such as DECIMAL values,
+// sign-extending the shorter one
+int CompareSignedBytes(const uint8_t* a, uint32_t a_len, const uint8_t* b,
+                       uint32_t b_len) {
+  const bool a_negative = a_len > 0 && (a[0] & 0x80) != 0;
+  const bool b_negative = b_len > 0 && (b[0] & 0x80) != 0;
+  if (a_negative != b_negative) {
+    return a_negative ? -1 : 1;
+  }
+  // With equal signs, the sign-extended bytes order like unsigned integers
+  const uint8_t pad = a_negative ? 0xFF : 0x00;
+  const uint32_t length = std::max(a_len, b_len);
+  for (uint32_t i = 0; i < length; ++i) {
+    const uint8_t a_byte = i < length - a_len ? pad : a[i - (length - a_len)];
+    const uint8_t b_byte = i < length - b_len ? pad : b[i - (length - b_len)];
+    if (a_byte != b_byte) {
+      return a_byte < b_byte ? -1 : 1;
+    }
+  }
+  return 0;
+}
+
+int CompareValues(const ByteArray& a, const ByteArray& b, const ColumnDescriptor* descr) {
+  if (descr->sort_order() == SortOrder::SIGNED) {
+    return CompareSignedBytes(a.ptr, a.len, b.ptr, b.len);
+  }
+  return CompareUnsignedBytes(a.ptr, a.len, b.ptr, b.len);
+}
+
+int CompareValues(const FLBA& a, const FLBA& b, const ColumnDescriptor* descr) {
+  const uint32_t length = static_cast<uint32_t>(descr->type_length());
+  if (descr->sort_order() == SortOrder::SIGNED) {
+    return CompareSignedBytes(a.ptr, length, b.ptr, length);
+  }
+  return CompareUnsignedBytes(a.ptr, length, b.ptr, length);
+}
+
+int CompareValues(const Int96&, const Int96&, const ColumnDescriptor*) {
+  throw ParquetException("INT96 columns cannot be used as sort keys");
+}
+
+// BYTE_ARRAY and FLBA values point into the pages of their reader, so the
+// output buffers keep their own copy of the bytes
+template <typename T>
+void StoreValue(const T& value, T* out, int, std::vector<uint8_t>*) {
+  *out = value;
+}
+
+void StoreValue(const ByteArray& value, ByteArray* out, int,
+                std::vector<uint8_t>* arena) {
+  arena->insert(arena->end(), value.ptr, value.ptr + value.len);
+  out->len = value.len;
+  out->ptr = nullptr;
+}
+
+void StoreValue(const FLBA& value, FLBA* out, int type_length,
+                std::vector<uint8_t>* arena) {
+  arena->insert(arena->end(), value.ptr, value.ptr + type_length);
+  out->ptr = nullptr;
+}
+
+// Points the stored values at their bytes once the arena no longer grows
+template <typename T>
+void ResolveValues(T*, int64_t, int, const std::vector<uint8_t>&) {}
+
+void ResolveValues(ByteArray* values, int64_t num_values, int,
+                   const std::vector<uint8_t>& arena) {
+  const uint8_t* ptr = arena.data();
+  for (int64_t i = 0; i < num_values; ++i) {
+    values[i].ptr = ptr;
+    ptr += values[i].len;
+  }
+}
+
+void ResolveValues(FLBA* values, int64_t num_values, int type_length,
+                   const std::vector<uint8_t>& arena) {
+  for (int64_t i = 0; i < num_values; ++i) {
+    values[i].ptr = arena.data() + i * type_length;
+  }
+}
+
+// ----------------------------------------------------------------------
+// Output buffers feeding the buffered row group writer
+
+class ColumnBuffer {
+ public:
+  virtual ~ColumnBuffer() {}
+  virtual void Flush(ColumnWriter* writer) = 0;
+  virtual int64_t EstimatedBufferedValueBytes(ColumnWriter* writer) const = 0;
+};
+
+template <typename DType>
+class TypedColumnBuffer : public ColumnBuffer {
+ public:
+  using T = typename DType::c_type;
+
+  explicit TypedColumnBuffer(const ColumnDescriptor* descr)
+      : descr_(descr),
+        def_levels_(kSortedMergeBatchSize),
+        values_(new T[kSortedMergeBatchSize]),
+        num_levels_(0),
+        num_values_(0) {}
+
+  // A null `value` appends a null
+  void Append(int16_t def_level, const T* value) {
+    def_levels_[num_levels_++] = def_level;
+    if (value != nullptr) {
+      StoreValue(*value, &values_[num_values_++], descr_->type_length(), &arena_);
+    }
+  }
+
+  void Flush(ColumnWriter* writer) override {
+    ResolveValues(values_.get(), num_values_, descr_->type_length(), arena_);
+    static_cast<TypedColumnWriter<DType>*>(writer)->WriteBatch(
+        num_levels_, def_levels_.data(), nullptr, values_.get());
+    arena_.clear();
+    num_levels_ = 0;
+    num_values_ = 0;
+  }
+
+  int64_t EstimatedBufferedValueBytes(ColumnWriter* writer) const override {
+    return static_cast<TypedColumnWriter<DType>*>(writer)->EstimatedBufferedValueBytes();
+  }
+
+ private:
+  const ColumnDescriptor* descr_;
+  std::vector<int16_t> def_levels_;
+  std::unique_ptr<T[]> values_;
+  std::vector<uint8_t> arena_;
+  int64_t num_levels_;
+  int64_t num_values_;
+};
+
+// ----------------------------------------------------------------------
+// Row cursors over the column chunks of an input
+
+class ColumnCursor {
+ public:
+  virtual ~ColumnCursor() {}
+  // Starts reading a new column chunk and positions on its first row
+  virtual void Reset(const std::shared_ptr<ColumnReader>& reader) = 0;
+  virtual void Advance() = 0;
+  virtual int Compare(const ColumnCursor& other) const = 0;
+  virtual void AppendTo(ColumnBuffer* out) const = 0;
+  // Keeps a copy of the current value, which stays valid across Advance()
+  virtual void SaveValue() = 0;
+  // Compares the current value with the one kept by SaveValue()
+  virtual int CompareToSaved() const = 0;
+};
+
+template <typename DType>
+class TypedColumnCursor : public ColumnCursor {
+ public:
+  using T = typename DType::c_type;
+
+  explicit TypedColumnCursor(const ColumnDescriptor* descr)
+      : descr_(descr),
+        def_levels_(kSortedMergeBatchSize),
+        values_(new T[kSortedMergeBatchSize]),
+        levels_buffered_(0),
+        level_pos_(0),
+        value_pos_(0) {}
+
+  void Reset(const std::shared_ptr<ColumnReader>& reader) override {
+    reader_ = reader;
+    levels_buffered_ = 0;
+    level_pos_ = 0;
+    value_pos_ = 0;
+    Advance();
+  }
+
+  void Advance() override {
+    if (level_pos_ < levels_buffered_) {
+      if (!IsNull()) {
+        ++value_pos_;
+      }
+      ++level_pos_;
+    }
+    if (level_pos_ == levels_buffered_) {
+      int64_t values_read = 0;
+      levels_buffered_ = static_cast<TypedColumnReader<DType>*>(reader_.get())
+                             ->ReadBatch(kSortedMergeBatchSize, def_levels_.data(),
+                                         nullptr, values_.get(), &values_read);
+      level_pos_ = 0;
+      value_pos_ = 0;
+    }
+  }
+
+  int Compare(const ColumnCursor& other) const override {
+    const auto& typed_other = static_cast<const TypedColumnCursor<DType>&>(other);
+    return CompareNullable(IsNull(), values_[value_pos_], typed_other.IsNull(),
+                           typed_other.values_[typed_other.value_pos_]);
+  }
+
+  void SaveValue() override {
+    saved_null_ = IsNull();
+    if (!saved_null_) {
+      saved_arena_.clear();
+      StoreValue(values_[value_pos_], &saved_value_, descr_->type_length(),
+                 &saved_arena_);
+      ResolveValues(&saved_value_, 1, descr_->type_length(), saved_arena_);
+    }
+  }
+
+  int CompareToSaved() const override {
+    return CompareNullable(IsNull(), values_[value_pos_], saved_null_, saved_value_);
+  }
+
+  void AppendTo(ColumnBuffer* out) const override {
+    auto typed_out = static_cast<TypedColumnBuffer<DType>*>(out);
+    if (IsNull()) {
+      typed_out->Append(def_levels_[level_pos_], nullptr);
+    } else {
+      typed_out->Append(descr_->max_definition_level(), &values_[value_pos_]);
+    }
+  }
+
+ private:
+  bool IsNull() const {
+    return descr_->max_definition_level() > 0 &&
+           def_levels_[level_pos_] < descr_->max_definition_level();
+  }
+
+  // Nulls sort first; `a` and `b` are only looked at when not null
+  int CompareNullable(bool a_null, const T& a, bool b_null, const T& b) const {
+    if (a_null || b_null) {
+      return static_cast<int>(b_null) - static_cast<int>(a_null);
+    }
+    return CompareValues(a, b, descr_);
+  }
+
+  const ColumnDescriptor* descr_;
+  std::shared_ptr<ColumnReader> reader_;
+  std::vector<int16_t> def_levels_;
+  std::unique_ptr<T[]> values_;
+  int64_t levels_buffered_;
+  int64_t level_pos_;
+  int64_t value_pos_;
+  bool saved_null_ = true;
+  T saved_value_;
+  std::vector<uint8_t> saved_arena_;
+};
+
+template <template <typename> class Typed, typename Base>
+std::unique_ptr<Base> MakeTyped(const ColumnDescriptor* descr) {
+  switch (descr->physical_type()) {
+    case Type::BOOLEAN:
+      return std::unique_ptr<Base>(new Typed<BooleanType>(descr));
+    case Type::INT32:
+      return std::unique_ptr<Base>(new Typed<Int32Type>(descr));
+    case Type::INT64:
+      return std::unique_ptr<Base>(new Typed<Int64Type>(descr));
+    case Type::INT96:
+      return std::unique_ptr<Base>(new Typed<Int96Type>(descr));
+    case Type::FLOAT:
+      return std::unique_ptr<Base>(new Typed<FloatType>(descr));
+    case Type::DOUBLE:
+      return std::unique_ptr<Base>(new Typed<DoubleType>(descr));
+    case Type::BYTE_ARRAY:
+      return std::unique_ptr<Base>(new Typed<ByteArrayType>(descr));
+    case Type::FIXED_LEN_BYTE_ARRAY:
+      return std::unique_ptr<Base>(new Typed<FLBAType>(descr));
+    default:
+      throw ParquetException("Unsupported physical type");
+  }
+}
+
+// Streams the rows of one input file across all of its row groups
+class InputCursor {
+ public:
+  InputCursor(const std::string& path, const std::shared_ptr<FileMetaData>& footer)
+      : path_(path),
+        reader_(ParquetFileReader::OpenFile(path, false, default_reader_properties(),
+                                            footer)),
+        row_group_(-1),
+        rows_left_(0) {
+    const SchemaDescriptor* schema = footer->schema();
+    for (int i = 0; i < schema->num_columns(); ++i) {
+      columns_.push_back(MakeTyped<TypedColumnCursor, ColumnCursor>(schema->Column(i)));
+    }
+    NextRowGroup();
+  }
+
+  bool exhausted() const { return rows_left_ == 0; }
+
+  const ColumnCursor& column(int i) const { return *columns_[i]; }
+
+  // Moves to the next row and throws if it sorts before the current one on
+  // `sort_columns`
+  void AdvanceSorted(const std::vector<int>& sort_columns) {
+    for (int column : sort_columns) {
+      columns_[column]->SaveValue();
+    }
+    Advance();
+    if (exhausted()) {
+      return;
+    }
+    for (int column : sort_columns) {
+      int cmp = columns_[column]->CompareToSaved();
+      if (cmp < 0) {
+        throw ParquetException(path_ + " is not sorted by the sort columns");
+      }
+      if (cmp > 0) {
+        return;
+      }
+    }
+  }
+
+  void Advance() {
+    if (--rows_left_ > 0) {
+      for (auto& column : columns_) {
+        column->Advance();
+      }
+    } else {
+      NextRowGroup();
+    }
+  }
+
+ private:
+  void NextRowGroup() {
+    const int num_row_groups = reader_->metadata()->num_row_groups();
+    while (rows_left_ == 0 && ++row_group_ < num_row_groups) {
+      std::shared_ptr<RowGroupReader> row_group = reader_->RowGroup(row_group_);
+      rows_left_ = row_group->metadata()->num_rows();
+      if (rows_left_ > 0) {
+        for (size_t i = 0; i < columns_.size(); ++i) {
+          columns_[i]->Reset(row_group->Column(static_cast<int>(i)));
+        }
+      }
+    }
+  }
+
+  std::string path_;
+  std::unique_ptr<ParquetFileReader> reader_;
+  std::vector<std::unique_ptr<ColumnCursor>> columns_;
+  int row_group_;
+  int64_t rows_left_;
+};
+
+// ----------------------------------------------------------------------
+// Loser tree over the current rows of all inputs
+
+class LoserTree {
+ public:
+  LoserTree(std::vector<std::unique_ptr<InputCursor>>* inputs,
+            const std::vector<int>& sort_columns)
+      : inputs_(*inputs),
+        sort_columns_(sort_columns),
+        k_(static_cast<int>(inputs->size())),
+        losers_(k_, k_) {
+    // Every node starts out holding the virtual leaf k_, which beats all
+    // real inputs and is pushed out of the tree as the leaves are replayed
+    for (int i = k_ - 1; i >= 0; --i) {
+      Replay(i);
+    }
+  }
+
+  // Index of the input holding the smallest current row, or -1 once all
+  // inputs are exhausted
+  int winner() const {
+    int winner = losers_[0];
+    return inputs_[winner]->exhausted() ? -1 : winner;
+  }
+
+  // Must be called after the winning input has advanced
+  void Replay(int input) {
+    int winner = input;
+    for (int node = (input + k_) / 2; node > 0; node /= 2) {
+      if (Less(losers_[node], winner)) {
+        std::swap(losers_[node], winner);
+      }
+    }
+    losers_[0] = winner;
+  }
+
+ private:
+  bool Less(int a, int b) const {
+    if (a == k_ || b == k_) {
+      return a == k_ && b != k_;
+    }
+    const InputCursor& left = *inputs_[a];
+    const InputCursor& right = *inputs_[b];
+    if (left.exhausted() || right.exhausted()) {
+      return !left.exhausted() || (right.exhausted() && a < b);
+    }
+    for (int column : sort_columns_) {
+      int cmp = left.column(column).Compare(right.column(column));
+      if (cmp != 0) {
+        return cmp < 0;
+      }
+    }
+    // Equal keys keep the order of the inputs
+    return a < b;
+  }
+
+  const std::vector<std::unique_ptr<InputCursor>>& inputs_;
+  const std::vector<int>& sort_columns_;
+  const int k_;
+  std::vector<int> losers_;
+};
+
+}  // namespace
+
+MergeStats MergeSortedFiles(const std::vector<std::string>& paths,
+                            const std::shared_ptr<::arrow::io::OutputStream>& sink,
+                            const MergeOptions& options) {
+  if (paths.empty()) {
+    throw ParquetException("No input files to merge");
+  }
+  if (options.sort_columns.empty()) {
+    throw ParquetException("A sorted merge needs at least one key column");
+  }
+
+  std::vector<std::shared_ptr<FileMetaData>> footers;
+  std::shared_ptr<FileMetaData> prototype;
+  for (const std::string& path : paths) {
+    footers.push_back(ReadFileFooter(path));
+    if (!footers.back()->schema()->Equals(*footers[0]->schema())) {
+      throw ParquetException(path + ": schema differs from " + paths[0]);
+    }
+    if (!prototype || prototype->num_row_groups() == 0) {
+      prototype = footers.back();
+    }
+  }
+
+  const SchemaDescriptor* schema = prototype->schema();
+  for (int i = 0; i < schema->num_columns(); ++i) {
+    if (schema->Column(i)->max_repetition_level() > 0) {
+      throw ParquetException(
+          "Sorted merge supports only schemas without repeated fields");
+    }
+  }
+  for (int column : options.sort_columns) {
+    if (column < 0 || column >= schema->num_columns()) {
+      std::stringstream ss;
+      ss << "Sort column " << column << " does not exist";
+      throw ParquetException(ss.str());
+    }
+    if (schema->Column(column)->physical_type() == Type::INT96) {
+      throw ParquetException("INT96 columns cannot be used as sort keys");
+    }
+    if (schema->Column(column)->sort_order() == SortOrder::UNKNOWN) {
+      throw ParquetException("Column " + schema->Column(column)->path()->ToDotString() +
+                             " has no defined sort order");
+    }
+  }
+
+  MergeStats stats;
+  std::vector<std::unique_ptr<InputCursor>> inputs;
+  for (size_t i = 0; i < paths.size(); ++i) {
+    inputs.emplace_back(new InputCursor(paths[i], footers[i]));
+    // Every row is decoded and encoded again
+    for (int r = 0; r < footers[i]->num_row_groups(); ++r) {
+      std::unique_ptr<RowGroupMetaData> row_group = footers[i]->RowGroup(r);
+      for (int c = 0; c < row_group->num_columns(); ++c) {
+        stats.bytes_reencoded += row_group->ColumnChunk(c)->total_compressed_size();
+      }
+      stats.num_reencoded_row_groups++;
+      stats.num_input_row_groups++;
+    }
+  }
+  LoserTree tree(&inputs, options.sort_columns);
+
+  const int64_t row_group_size =
+      options.row_group_size > 0 ? options.row_group_size : kDefaultRowGroupSize;
+  std::unique_ptr<ParquetFileWriter> file_writer = ParquetFileWriter::Open(
+      sink, std::static_pointer_cast<schema::GroupNode>(schema->schema_root()),
+      PrototypeProperties(*prototype), prototype->key_value_metadata());
+  std::vector<std::unique_ptr<ColumnBuffer>> buffers;
+  for (int i = 0; i < schema->num_columns(); ++i) {
+    buffers.push_back(MakeTyped<TypedColumnBuffer, ColumnBuffer>(schema->Column(i)));
+  }
+
+  // Row groups are opened lazily so that the file never ends with an empty one
+  RowGroupWriter* rg_writer = nullptr;
+  int64_t rows_buffered = 0;
+  auto flush_buffers = [&]() {
+    if (rg_writer == nullptr) {
+      rg_writer = file_writer->AppendBufferedRowGroup();
+    }
+    for (int i = 0; i < schema->num_columns(); ++i) {
+      buffers[i]->Flush(rg_writer->column(i));
+    }
+    rows_buffered = 0;
+  };
+
+  for (int winner = tree.winner(); winner >= 0; winner = tree.winner()) {
+    for (int i = 0; i < schema->num_columns(); ++i) {
+      inputs[winner]->column(i).AppendTo(buffers[i].get());
+    }
+    // Inputs that are not sorted would silently produce unsorted output
+    inputs[winner]->AdvanceSorted(options.sort_columns);
+    tree.Replay(winner);
+    stats.num_rows++;
+
+    if (++rows_buffered == kSortedMergeBatchSize) {
+      flush_buffers();
+      // Same estimate as in the buffered row group example: the pages already
+      // written plus the values not yet encoded into a page
+      int64_t estimated_bytes =
+          rg_writer->total_bytes_written() + rg_writer->total_compressed_bytes();
+      for (int i = 0; i < schema->num_columns(); ++i) {
+        estimated_bytes += buffers[i]->EstimatedBufferedValueBytes(rg_writer->column(i));
+      }
+      if (estimated_bytes > row_group_size) {
+        rg_writer->Close();
+        rg_writer = nullptr;
+        stats.num_output_row_groups++;
+      }
+    }
+  }
+  if (rows_buffered > 0) {
+    flush_buffers();
+  }
+  if (rg_writer != nullptr) {
+    rg_writer->Close();
+    stats.num_output_row_groups++;
+  }
+  file_writer->Close();
+  return stats;
+}
+
+}  // namespace tools
+}  // namespace parquet